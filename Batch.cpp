@@ -0,0 +1,367 @@
+/**
+*  Batch.cpp
+*
+*  Defines the batch job mode, which sorts many input files in one process on a shared pool of workers
+*/
+
+#include "Batch.hpp"
+#include "ThreadPool.hpp"
+#include "Stopwatch.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+
+
+/*** Function Definitions ***/
+
+// Applies one setting from a manifest line (an algorithm name, "seq", "par" or a thread count) to 'job'
+//
+static bool parseJobSetting(std::string setting, BatchJob* job)
+{
+	if (setting == "seq")
+	{
+		job->parallel = false;
+	}
+	else if (setting == "par")
+	{
+		job->parallel = true;
+	}
+	else if (setting.find_first_not_of("0123456789") == std::string::npos)
+	{
+		if (setting.size() > 3)
+			return false;
+		
+		job->numThreads = std::stoi(setting);
+		
+		if (job->numThreads < MIN_NUM_THREADS || job->numThreads > MAX_NUM_THREADS)
+			return false;
+	}
+	else
+	{
+		job->algorithm = parseAlgorithmName(setting);
+		
+		if (job->algorithm == SortAlgorithm::None)
+			return false;
+	}
+	
+	return true;
+}
+
+
+bool readBatchManifest(std::string path, BatchJob defaults, std::vector<BatchJob>* jobs, std::string* error)
+{
+	std::error_code ec;
+	
+	if (std::filesystem::is_directory(path, ec))
+	{
+		std::vector<std::string> files;
+		
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path, ec))
+		{
+			if (entry.is_regular_file() && entry.path().filename().string()[0] != '.')
+			{
+				files.push_back(entry.path().string());
+			}
+		}
+		
+		if (ec)
+		{
+			*error = "Cannot read directory \"" + path + "\"";
+			return false;
+		}
+		
+		std::sort(files.begin(), files.end());
+		
+		for (std::string& file : files)
+		{
+			BatchJob job = defaults;
+			job.dataFile = file;
+			
+			jobs->push_back(job);
+		}
+		
+		return true;
+	}
+	
+	std::ifstream manifest(path);
+	
+	if (!manifest.is_open())
+	{
+		*error = "Cannot open batch manifest \"" + path + "\"";
+		return false;
+	}
+	
+	std::filesystem::path baseDir = std::filesystem::path(path).parent_path();
+	
+	std::string line;
+	int32_t lineNumber = 0;
+	
+	while (std::getline(manifest, line))
+	{
+		lineNumber++;
+		
+		line = line.substr(0, line.find('#'));
+		
+		std::stringstream lineStream(line);
+		std::string file;
+		
+		if (!(lineStream >> file))
+			continue;
+		
+		BatchJob job = defaults;
+		
+		std::filesystem::path filePath(file);
+		
+		job.dataFile = (filePath.is_relative()) ? (baseDir / filePath).string() : file;
+		
+		std::string setting;
+		
+		while (lineStream >> setting)
+		{
+			if (!parseJobSetting(setting, &job))
+			{
+				*error = "Invalid setting \"" + setting + "\" on line " + std::to_string(lineNumber) + " of \"" + path + "\"";
+				return false;
+			}
+		}
+		
+		if (job.algorithm == SortAlgorithm::None)
+		{
+			*error = "Sorting algorithm not specified on line " + std::to_string(lineNumber) + " of \"" + path + "\"";
+			return false;
+		}
+		
+		jobs->push_back(job);
+	}
+	
+	return true;
+}
+
+
+void runBatch(std::vector<BatchJob>* jobs, int32_t numCores, bool verify, std::vector<BatchResult>* results)
+{
+	results->assign(jobs->size(), BatchResult());
+	
+	CoreBudget budget;
+	budget.available = numCores;
+	
+	std::mutex printLock;
+	size_t finished = 0;
+	
+	/* One buffer per worker, kept between jobs so its capacity is reused instead of reallocated */
+	
+	std::vector<std::vector<int32_t>> buffers(numCores);
+	
+	ThreadPool pool(numCores);
+	
+	for (size_t j = 0; j < jobs->size(); j++)
+	{
+		pool.submit([&, j](int32_t worker)
+		{
+			BatchResult* result = &(results->at(j));
+			
+			result->job = jobs->at(j);
+			result->worker = worker;
+			result->cores = (result->job.parallel) ? std::min(result->job.numThreads, numCores) : 1;
+			
+			std::vector<int32_t>* buffer = &(buffers[worker]);
+			buffer->clear();
+			
+			
+			/* Load outside of the core budget, so reading one file overlaps with sorting others */
+			
+			Stopwatch loadTimer;
+			loadTimer.start();
+			
+			result->loaded = readTestData(result->job.dataFile, buffer, &(result->error));
+			
+			loadTimer.stop();
+			
+			result->loadTime = loadTimer.getSeconds();
+			
+			if (result->loaded)
+			{
+				SortParameters param{};
+				
+				param.dataFile = result->job.dataFile;
+				param.algorithm = result->job.algorithm;
+				param.parallel = result->job.parallel;
+				param.numThreads = result->cores;		// A parallel job never runs more threads than it reserved
+				param.data.swap(*buffer);
+				
+				result->dataLength = param.data.size();
+				
+				acquireCores(&budget, result->cores);
+				
+				Stopwatch sortTimer;
+				sortTimer.start();
+				
+				runSortingAlgorithm(&param);
+				
+				sortTimer.stop();
+				
+				releaseCores(&budget, result->cores);
+				
+				result->sortTime = sortTimer.getSeconds();
+				
+				if (verify)
+				{
+					result->verified = true;
+					result->sortedCorrectly = isSorted(&(param.data));
+				}
+				
+				buffer->swap(param.data);
+			}
+			
+			
+			/* Progress */
+			
+			std::stringstream progress;
+			
+			if (result->loaded)
+			{
+				progress << getAlgorithmName(result->job.algorithm);
+				
+				if (result->job.parallel)
+					progress << " (" << result->cores << " threads)";
+				
+				progress << ", " << result->dataLength << " values, " << std::fixed << std::setprecision(6) << result->sortTime << " seconds";
+				
+				if (result->verified && !result->sortedCorrectly)
+					progress << "  (WARNING: not sorted)";
+			}
+			else
+			{
+				progress << "(ERROR) " << result->error;
+			}
+			
+			std::lock_guard<std::mutex> guard(printLock);
+			
+			finished++;
+			
+			std::cout << " [" << finished << "/" << jobs->size() << "] " << result->job.dataFile << ": " << progress.str() << "\n";
+		});
+	}
+	
+	pool.wait();
+}
+
+
+// Gets the verification column of a result
+//
+static std::string batchStatus(BatchResult* result)
+{
+	if (!result->loaded)
+		return "load failed";
+	else if (!result->verified)
+		return "disabled";
+	
+	return (result->sortedCorrectly) ? "passed" : "failed";
+}
+
+
+bool writeBatchReport(std::vector<BatchResult>* results, int32_t numCores, double wallTime, std::string timestamp, std::string fileName)
+{
+	std::ofstream report(fileName);
+	
+	if (!report.is_open())
+	{
+		return false;
+	}
+	
+	size_t totalValues = 0;
+	size_t failedLoads = 0;
+	size_t failedSorts = 0;
+	
+	double totalLoad = 0.0;
+	double totalSort = 0.0;
+	
+	for (BatchResult& r : *results)
+	{
+		totalValues += r.dataLength;
+		totalLoad += r.loadTime;
+		totalSort += r.sortTime;
+		
+		if (!r.loaded)
+			failedLoads++;
+		else if (r.verified && !r.sortedCorrectly)
+			failedSorts++;
+	}
+	
+	report << std::fixed << std::setprecision(6);
+	
+	report << "Timestamp         : " << timestamp << "\n";
+	report << "Batch Jobs        : " << results->size() << "\n";
+	report << "Worker Cores      : " << numCores << "\n";
+	report << "Total Data Length : " << totalValues << "\n";
+	report << "Wall Time         : " << wallTime << " seconds\n";
+	report << "  Total Load      : " << totalLoad << " seconds (summed over jobs)\n";
+	report << "  Total Sort      : " << totalSort << " seconds (summed over jobs)\n";
+	report << "Failed Loads      : " << failedLoads << "\n";
+	report << "Failed Sorts      : " << failedSorts << "\n\n";
+	
+	for (size_t j = 0; j < results->size(); j++)
+	{
+		BatchResult& r = results->at(j);
+		
+		report << "Job " << (j + 1) << "\n";
+		report << "  Test Data         : " << r.job.dataFile << "\n";
+		
+		if (!r.loaded)
+		{
+			report << "  Error             : " << r.error << "\n\n";
+			continue;
+		}
+		
+		report << "  Data Length       : " << r.dataLength << "\n";
+		report << "  Sorting Algorithm : " << getAlgorithmName(r.job.algorithm) << "\n";
+		report << "  Parallel Version  : " << ((r.job.parallel) ? "yes" : "no") << "\n";
+		
+		if (r.job.parallel)
+		{
+			report << "  Number of Threads : " << r.cores << "\n";
+		}
+		
+		report << "  Load Time         : " << r.loadTime << " seconds\n";
+		report << "  Execution Time    : " << r.sortTime << " seconds\n";
+		report << "  Verification      : " << batchStatus(&r) << "\n\n";
+	}
+	
+	return true;
+}
+
+
+bool writeBatchCSV(std::vector<BatchResult>* results, std::string fileName)
+{
+	std::ofstream csv(fileName);
+	
+	if (!csv.is_open())
+	{
+		return false;
+	}
+	
+	csv << "dataset,algorithm,version,threads,cores,worker,size,load_time,sort_time,verification\n";
+	
+	csv << std::setprecision(6) << std::fixed;
+	
+	for (BatchResult& r : *results)
+	{
+		csv << r.job.dataFile << ","
+		    << getAlgorithmKey(r.job.algorithm) << ","
+		    << ((r.job.parallel) ? "parallel" : "sequential") << ","
+		    << ((r.job.parallel) ? r.job.numThreads : 1) << ","
+		    << r.cores << ","
+		    << r.worker << ","
+		    << r.dataLength << ","
+		    << r.loadTime << ","
+		    << r.sortTime << ","
+		    << batchStatus(&r) << "\n";
+	}
+	
+	return true;
+}
@@ -0,0 +1,75 @@
+/**
+*  Batch.hpp
+*
+*  Declares the batch job mode, which sorts many input files in one process on a shared pool of workers
+*/
+
+#ifndef BATCH_HPP_MULTITHREADED_SORTING
+#define BATCH_HPP_MULTITHREADED_SORTING
+
+
+#include "SortRunner.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+/*** Data Structures ***/
+
+struct BatchJob
+{
+	std::string dataFile;
+	SortAlgorithm algorithm{};
+	bool parallel{};
+	int32_t numThreads = DEFAULT_NUM_THREADS;
+};
+
+struct BatchResult
+{
+	BatchJob job;
+	
+	int32_t worker{};			// Pool worker that ran the job
+	int32_t cores{};			// Cores reserved for the job while it was sorting
+	
+	size_t dataLength{};
+	double loadTime{};			// In seconds
+	double sortTime{};			// In seconds
+	
+	bool loaded{};
+	std::string error;			// Why the file could not be loaded
+	
+	bool verified{};
+	bool sortedCorrectly{};
+};
+
+
+
+/*** Function Declarations ***/
+
+// Reads the jobs listed in 'path' into 'jobs'. 'path' is either a directory, where every regular file
+// becomes a job with the settings of 'defaults', or a manifest with one job per line:
+//
+//     <file> [algorithm] [seq|par] [threads]
+//
+// Settings left out of a line are taken from 'defaults', relative file names are relative to the manifest
+// and '#' starts a comment. Returns false and sets 'error' if the manifest is invalid
+//
+bool readBatchManifest(std::string path, BatchJob defaults, std::vector<BatchJob>* jobs, std::string* error);
+
+// Loads, sorts and (optionally) verifies every job on a pool of 'numCores' workers, so small jobs run
+// side by side. Parallel jobs reserve up to their thread count in cores before sorting, and each worker
+// reuses its data buffer from one job to the next. Results are placed in 'results' in the order of 'jobs'
+//
+void runBatch(std::vector<BatchJob>* jobs, int32_t numCores, bool verify, std::vector<BatchResult>* results);
+
+// Saves the consolidated batch report, with one line per job and the totals
+//
+bool writeBatchReport(std::vector<BatchResult>* results, int32_t numCores, double wallTime, std::string timestamp, std::string fileName);
+
+// Saves the batch results as a ".csv" table
+//
+bool writeBatchCSV(std::vector<BatchResult>* results, std::string fileName);
+
+
+#endif
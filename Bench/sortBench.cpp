@@ -0,0 +1,623 @@
+/**
+*  sortBench.cpp
+*
+*  Defines the kernel micro-benchmarks built and run by "make bench". Each kernel (partition, merge,
+*  insertion sort, the small-array base cases, load/parse and verify) is timed on its own, over a range
+*  of sizes and input distributions, so a regression can be traced to the kernel that caused it
+*/
+
+#include "../SortRunner.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLE_COUNTER 1
+#else
+#define HAVE_CYCLE_COUNTER 0
+#endif
+
+
+
+/*** Constants ***/
+
+const size_t BENCH_SIZES[] = { 16, 64, 256, 1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18, 1 << 20, 1 << 22,
+                               1 << 24, 1 << 26, 100000000 };
+
+const size_t DEFAULT_MIN_SIZE = 16;
+const size_t DEFAULT_MAX_SIZE = 1 << 22;
+
+const size_t SAMPLE_ELEMENTS = 1 << 16;		// Small sizes run on enough segments to reach this many values per sample
+
+const int32_t DEFAULT_SAMPLES = 15;
+const int32_t DEFAULT_WARMUP = 2;
+
+const char* BENCH_PARSE_FILE = "sortbench_parse.tmp";
+
+const char* usageStr =
+	"\n Usage: sortbench [options...]\n\n"
+	"    --kernels  : Comma separated kernels to run (default: all)\n"
+	"                 <partition|partition3|merge|insertion|quicksort|sorttile|parse|verify>\n"
+	"    --dists    : Comma separated input distributions <random|sorted|reversed|dups> (default: all)\n"
+	"    --min-size : Smallest number of values per kernel call (default: 16)\n"
+	"    --max-size : Largest number of values per kernel call, up to 100000000 (default: 4194304)\n"
+	"    --samples  : Timed samples per case, before outliers are rejected (default: 15)\n"
+	"    --warmup   : Untimed samples run before the timed ones (default: 2)\n"
+	"    --csv      : Also save the results to the given \".csv\" file\n"
+	"    --help     : Show this message\n\n";
+
+
+
+/*** Data Structures ***/
+
+// Input of one case. 'pristine' holds 'segments' independent inputs of 'length' values back to back, so
+// kernels on tiny inputs run many times per sample instead of being lost in the timer overhead
+//
+struct BenchInput
+{
+	size_t length{};
+	size_t segments{};
+	
+	std::vector<int32_t> pristine;
+	std::vector<int32_t> work;		// Copy of 'pristine' the in-place kernels modify, refreshed before every sample
+	std::vector<int32_t> single;	// First segment on its own, for the kernels that take a whole vector
+	std::vector<int32_t> scratch;
+	
+	std::string file;
+};
+
+struct BenchKernel
+{
+	std::string name;
+	std::string description;
+	
+	bool inPlace{};		// Modifies 'work', which must be restored between samples
+	size_t maxSize{};	// Larger inputs are skipped (0 for no limit)
+	
+	void (*prepare)(int32_t* segment, size_t length);	// Shapes each generated segment, may be nullptr
+	void (*run)(BenchInput* input);						// Calls the kernel once on every segment
+};
+
+struct BenchResult
+{
+	std::string kernel;
+	std::string distribution;
+	size_t length{};
+	
+	double nsPerElement{};		// Median of the samples that were kept
+	double minNsPerElement{};
+	double cyclesPerElement{};	// Median of the samples that were kept, in time stamp counter cycles
+	
+	int32_t keptSamples{};
+	int32_t totalSamples{};
+};
+
+
+
+/*** Kernel Declarations ***/
+
+// Reuse the kernels from the sort implementations
+//
+int64_t partition(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void partition3(std::vector<int32_t>& arr, int64_t low, int64_t high, int64_t* lt, int64_t* gt);
+void quickSort(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void merge(const int32_t* src, size_t mid, size_t n, int32_t* dst);
+void insertionSort(std::vector<int32_t>* arr, int64_t left, int64_t right);
+void sortTile(int32_t* tile, int32_t* scratch, size_t length);
+
+
+// Keeps the results of the read-only kernels alive, so the compiler cannot drop the calls
+//
+static volatile size_t benchSink;
+
+
+
+/*** Kernels ***/
+
+static void sortSegment(int32_t* segment, size_t length)
+{
+	std::sort(segment, segment + length);
+}
+
+
+static void sortHalves(int32_t* segment, size_t length)
+{
+	std::sort(segment, segment + length / 2);
+	std::sort(segment + length / 2, segment + length);
+}
+
+
+static void runPartition(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		int64_t low = s * input->length;
+		
+		benchSink = partition(input->work, low, low + input->length - 1);
+	}
+}
+
+
+static void runPartition3(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		int64_t low = s * input->length;
+		int64_t lt, gt;
+		
+		partition3(input->work, low, low + input->length - 1, &lt, &gt);
+		
+		benchSink = gt - lt;
+	}
+}
+
+
+static void runMerge(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		merge(input->work.data() + s * input->length, input->length / 2, input->length, input->scratch.data());
+	}
+}
+
+
+static void runInsertion(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		int64_t low = s * input->length;
+		
+		insertionSort(&(input->work), low, low + input->length - 1);
+	}
+}
+
+
+static void runQuickSort(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		int64_t low = s * input->length;
+		
+		quickSort(input->work, low, low + input->length - 1);
+	}
+}
+
+
+static void runSortTile(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		sortTile(input->work.data() + s * input->length, input->scratch.data(), input->length);
+	}
+}
+
+
+static void runParse(BenchInput* input)
+{
+	std::vector<int32_t> buffer;
+	std::string error;
+	
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		buffer.clear();
+		
+		readTestData(input->file, &buffer, &error);
+		
+		benchSink = buffer.size();
+	}
+}
+
+
+static void runVerify(BenchInput* input)
+{
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		benchSink = isSorted(&(input->single));
+	}
+}
+
+
+static std::vector<BenchKernel> getKernels()
+{
+	return {
+		{ "partition",  "Lomuto partition around the last value (seqQuickSort.cpp)",               true,  0,       nullptr,     runPartition },
+		{ "partition3", "Three-way Bentley-McIlroy partition (seqQuickSort.cpp)",                   true,  0,       nullptr,     runPartition3 },
+		{ "merge",      "Merge of two sorted halves into the scratch buffer (seqMergeSort.cpp)",    false, 0,       sortHalves,  runMerge },
+		{ "insertion",  "Insertion sort of a range (parInsertionSort.cpp)",                         true,  1 << 14, nullptr,     runInsertion },
+		{ "quicksort",  "Whole quick sort, the base case on small sizes (seqQuickSort.cpp)",        true,  0,       nullptr,     runQuickSort },
+		{ "sorttile",   "Block merge tile sort: insertion runs + merges (seqBlockMergeSort.cpp)",   true,  0,       nullptr,     runSortTile },
+		{ "parse",      "Load and parse of a text data file (readTestData)",                        false, 0,       nullptr,     runParse },
+		{ "verify",     "Check of sorted data (isSorted)",                                          false, 0,       sortSegment, runVerify }
+	};
+}
+
+
+
+/*** Inputs ***/
+
+// Fills 'segment' with 'length' values of the given distribution
+//
+static bool generateSegment(std::string distribution, int32_t* segment, size_t length, std::mt19937* rng)
+{
+	if (distribution == "random")
+	{
+		std::uniform_int_distribution<int32_t> values(INT32_MIN, INT32_MAX);
+		
+		for (size_t i = 0; i < length; i++)
+			segment[i] = values(*rng);
+	}
+	else if (distribution == "sorted" || distribution == "reversed")
+	{
+		std::uniform_int_distribution<int32_t> steps(0, 64);
+		
+		int32_t value = INT32_MIN / 2;
+		
+		for (size_t i = 0; i < length; i++)
+		{
+			segment[i] = value;
+			
+			value = (value < INT32_MAX / 2) ? value + steps(*rng) : value;
+		}
+		
+		if (distribution == "reversed")
+			std::reverse(segment, segment + length);
+	}
+	else if (distribution == "dups")
+	{
+		std::uniform_int_distribution<int32_t> values(0, 255);
+		
+		for (size_t i = 0; i < length; i++)
+			segment[i] = values(*rng);
+	}
+	else
+	{
+		return false;
+	}
+	
+	return true;
+}
+
+
+// Builds the input of one case, with as many segments of 'length' values as fit in a sample
+//
+static bool buildInput(BenchKernel* kernel, std::string distribution, size_t length, BenchInput* input)
+{
+	std::mt19937 rng(12345);
+	
+	input->length = length;
+	input->segments = std::max<size_t>(1, SAMPLE_ELEMENTS / length);
+	
+	input->pristine.assign(input->length * input->segments, 0);
+	
+	for (size_t s = 0; s < input->segments; s++)
+	{
+		int32_t* segment = input->pristine.data() + s * length;
+		
+		if (!generateSegment(distribution, segment, length, &rng))
+			return false;
+		
+		if (kernel->prepare != nullptr)
+			kernel->prepare(segment, length);
+	}
+	
+	input->work = input->pristine;
+	input->single.assign(input->pristine.begin(), input->pristine.begin() + length);
+	input->scratch.assign(length, 0);
+	
+	if (kernel->run == runParse)
+	{
+		std::ofstream file(BENCH_PARSE_FILE);
+		
+		for (int32_t value : input->single)
+			file << value << " ";
+		
+		input->file = BENCH_PARSE_FILE;
+	}
+	
+	return true;
+}
+
+
+
+/*** Measurement ***/
+
+static uint64_t readCycleCounter()
+{
+#if HAVE_CYCLE_COUNTER
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+
+static double median(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	
+	size_t mid = values.size() / 2;
+	
+	return (values.size() % 2) ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+
+// Runs the warmup and timed samples of one case. Samples outside the Tukey fences (more than 1.5
+// interquartile ranges beyond the quartiles), such as the ones hit by an interrupt, are rejected
+//
+static void measureCase(BenchKernel* kernel, BenchInput* input, int32_t samples, int32_t warmup, BenchResult* result)
+{
+	std::vector<double> ns;
+	std::vector<double> cycles;
+	
+	double elements = (double)input->length * input->segments;
+	
+	for (int32_t i = 0; i < warmup + samples; i++)
+	{
+		if (kernel->inPlace)
+		{
+			std::copy(input->pristine.begin(), input->pristine.end(), input->work.begin());
+		}
+		
+		auto startTime = std::chrono::steady_clock::now();
+		uint64_t startCycles = readCycleCounter();
+		
+		kernel->run(input);
+		
+		uint64_t endCycles = readCycleCounter();
+		auto endTime = std::chrono::steady_clock::now();
+		
+		if (i < warmup)
+			continue;
+		
+		ns.push_back(std::chrono::duration<double, std::nano>(endTime - startTime).count() / elements);
+		cycles.push_back((endCycles - startCycles) / elements);
+	}
+	
+	std::vector<double> sorted = ns;
+	std::sort(sorted.begin(), sorted.end());
+	
+	double q1 = sorted[(sorted.size() - 1) / 4];
+	double q3 = sorted[(3 * (sorted.size() - 1)) / 4];
+	double low = q1 - 1.5 * (q3 - q1);
+	double high = q3 + 1.5 * (q3 - q1);
+	
+	std::vector<double> keptNs;
+	std::vector<double> keptCycles;
+	
+	for (size_t i = 0; i < ns.size(); i++)
+	{
+		if (ns[i] >= low && ns[i] <= high)
+		{
+			keptNs.push_back(ns[i]);
+			keptCycles.push_back(cycles[i]);
+		}
+	}
+	
+	result->nsPerElement = median(keptNs);
+	result->minNsPerElement = sorted[0];
+	result->cyclesPerElement = median(keptCycles);
+	result->keptSamples = keptNs.size();
+	result->totalSamples = ns.size();
+}
+
+
+
+/*** Command Line ***/
+
+static std::vector<std::string> splitList(std::string list)
+{
+	std::vector<std::string> items;
+	std::stringstream listStream(list);
+	std::string item;
+	
+	while (std::getline(listStream, item, ','))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	
+	return items;
+}
+
+
+static size_t parseNumber(std::string option, std::string value, size_t min, size_t max)
+{
+	size_t number = 0;
+	
+	if (value.empty() || value.size() > 10 || value.find_first_not_of("0123456789") != std::string::npos
+	    || (number = std::stoull(value)) < min || number > max)
+	{
+		std::cout << "\n   ERROR: Invalid value \"" << value << "\" for " << option << " (" << min << " to " << max << ")\n\n";
+		exit(1);
+	}
+	
+	return number;
+}
+
+
+static std::string getOptionValue(int argc, char** argv, int* argi, std::string option)
+{
+	if (*argi + 1 >= argc)
+	{
+		std::cout << "\n   ERROR: Missing value for " << option << "\n\n";
+		exit(1);
+	}
+	
+	return argv[++(*argi)];
+}
+
+
+
+/*** Main ***/
+
+int main(int argc, char** argv)
+{
+	std::vector<BenchKernel> allKernels = getKernels();
+	std::vector<BenchKernel> kernels;
+	std::vector<std::string> distributions = { "random", "sorted", "reversed", "dups" };
+	
+	size_t minSize = DEFAULT_MIN_SIZE;
+	size_t maxSize = DEFAULT_MAX_SIZE;
+	int32_t samples = DEFAULT_SAMPLES;
+	int32_t warmup = DEFAULT_WARMUP;
+	std::string csvFile = "";
+	
+	for (int argi = 1; argi < argc; argi++)
+	{
+		std::string arg = argv[argi];
+		
+		if (arg == "--kernels")
+		{
+			for (std::string name : splitList(getOptionValue(argc, argv, &argi, arg)))
+			{
+				auto found = std::find_if(allKernels.begin(), allKernels.end(), [&](BenchKernel& k) { return k.name == name; });
+				
+				if (found == allKernels.end())
+				{
+					std::cout << "\n   ERROR: Unknown kernel \"" << name << "\"\n\n";
+					exit(1);
+				}
+				
+				kernels.push_back(*found);
+			}
+		}
+		else if (arg == "--dists")
+		{
+			distributions = splitList(getOptionValue(argc, argv, &argi, arg));
+			
+			for (std::string& distribution : distributions)
+			{
+				int32_t probe;
+				std::mt19937 rng;
+				
+				if (!generateSegment(distribution, &probe, 1, &rng))
+				{
+					std::cout << "\n   ERROR: Unknown distribution \"" << distribution << "\"\n\n";
+					exit(1);
+				}
+			}
+		}
+		else if (arg == "--min-size")
+		{
+			minSize = parseNumber(arg, getOptionValue(argc, argv, &argi, arg), 1, 100000000);
+		}
+		else if (arg == "--max-size")
+		{
+			maxSize = parseNumber(arg, getOptionValue(argc, argv, &argi, arg), 1, 100000000);
+		}
+		else if (arg == "--samples")
+		{
+			samples = parseNumber(arg, getOptionValue(argc, argv, &argi, arg), 1, 1000);
+		}
+		else if (arg == "--warmup")
+		{
+			warmup = parseNumber(arg, getOptionValue(argc, argv, &argi, arg), 0, 1000);
+		}
+		else if (arg == "--csv")
+		{
+			csvFile = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--help")
+		{
+			std::cout << usageStr;
+			return 0;
+		}
+		else
+		{
+			std::cout << "\n   ERROR: Unknown option \"" << arg << "\"\n" << usageStr;
+			exit(1);
+		}
+	}
+	
+	if (kernels.empty())
+	{
+		kernels = allKernels;
+	}
+	
+	
+	/* Run every kernel / distribution / size case */
+	
+	std::vector<BenchResult> results;
+	
+	std::cout << "\n Kernel micro-benchmarks: " << samples << " samples per case after " << warmup << " warmup, Tukey fence outlier rejection\n";
+	
+	if (!HAVE_CYCLE_COUNTER)
+		std::cout << " (no cycle counter on this architecture, cycles/elem shows 0)\n";
+	
+	for (BenchKernel& kernel : kernels)
+	{
+		std::cout << "\n " << kernel.name << ": " << kernel.description << "\n\n";
+		std::cout << "   " << std::left << std::setw(10) << "dist" << std::right << std::setw(11) << "size"
+		          << std::setw(12) << "ns/elem" << std::setw(12) << "min" << std::setw(14) << "cycles/elem" << std::setw(8) << "kept" << "\n";
+		
+		for (std::string& distribution : distributions)
+		{
+			for (size_t length : BENCH_SIZES)
+			{
+				if (length < minSize || length > maxSize || (kernel.maxSize != 0 && length > kernel.maxSize))
+					continue;
+				
+				BenchInput input;
+				buildInput(&kernel, distribution, length, &input);
+				
+				BenchResult result;
+				result.kernel = kernel.name;
+				result.distribution = distribution;
+				result.length = length;
+				
+				measureCase(&kernel, &input, samples, warmup, &result);
+				
+				results.push_back(result);
+				
+				std::cout << "   " << std::left << std::setw(10) << distribution << std::right << std::setw(11) << length
+				          << std::fixed << std::setprecision(3)
+				          << std::setw(12) << result.nsPerElement << std::setw(12) << result.minNsPerElement
+				          << std::setw(14) << result.cyclesPerElement
+				          << std::setw(5) << result.keptSamples << "/" << std::left << std::setw(2) << result.totalSamples << std::right << "\n";
+			}
+		}
+	}
+	
+	std::remove(BENCH_PARSE_FILE);
+	
+	std::cout << "\n";
+	
+	
+	/* Save */
+	
+	if (!csvFile.empty())
+	{
+		std::ofstream csv(csvFile);
+		
+		if (!csv.is_open())
+		{
+			std::cout << "\n   ERROR: Cannot create file \"" << csvFile << "\"\n\n";
+			exit(2);
+		}
+		
+		csv << "kernel,distribution,size,ns_per_element,min_ns_per_element,cycles_per_element,kept_samples,samples\n";
+		
+		csv << std::fixed << std::setprecision(6);
+		
+		for (BenchResult& r : results)
+		{
+			csv << r.kernel << "," << r.distribution << "," << r.length << ","
+			    << r.nsPerElement << "," << r.minNsPerElement << "," << r.cyclesPerElement << ","
+			    << r.keptSamples << "," << r.totalSamples << "\n";
+		}
+		
+		std::cout << " Results saved to \"" << csvFile << "\"\n\n";
+	}
+	
+	return 0;
+}
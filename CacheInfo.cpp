@@ -0,0 +1,122 @@
+/**
+*  CacheInfo.cpp
+*
+*  Defines the CPU cache size detection used to size cache-blocked sorts
+*/
+
+#include "CacheInfo.hpp"
+
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+
+
+// Reads the first word of 'fileName', or returns "" if it cannot be read
+//
+static std::string readSysValue(std::string fileName)
+{
+	std::ifstream file(fileName);
+	std::string value;
+	
+	file >> value;
+	
+	return value;
+}
+
+
+// Converts a /sys cache size such as "48K" or "2048K" to bytes (0 if it is not valid)
+//
+static size_t parseCacheSize(std::string size)
+{
+	size_t bytes = 0;
+	size_t i = 0;
+	
+	for (; i < size.size() && size[i] >= '0' && size[i] <= '9'; i++)
+	{
+		bytes = bytes * 10 + (size[i] - '0');
+	}
+	
+	if (i < size.size())
+	{
+		if (size[i] == 'K')
+			bytes <<= 10;
+		else if (size[i] == 'M')
+			bytes <<= 20;
+		else if (size[i] == 'G')
+			bytes <<= 30;
+	}
+	
+	return bytes;
+}
+
+
+// Reads every cache index of cpu0, keeping the data/unified caches of levels 1, 2 and the highest level
+//
+static CacheInfo detectCacheInfo()
+{
+	CacheInfo cache{};
+	
+	int32_t llcLevel = 0;
+	
+	for (int32_t index = 0; index < 16; index++)
+	{
+		std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+		
+		std::string level = readSysValue(dir + "level");
+		std::string type = readSysValue(dir + "type");
+		
+		if (level.empty())
+			break;
+		
+		if (type == "Instruction")
+			continue;
+		
+		size_t size = parseCacheSize(readSysValue(dir + "size"));
+		int32_t levelNumber = std::stoi(level);
+		
+		if (levelNumber == 1)
+			cache.l1d = size;
+		else if (levelNumber == 2)
+			cache.l2 = size;
+		
+		if (levelNumber >= 2 && levelNumber > llcLevel)
+		{
+			cache.llc = size;
+			llcLevel = levelNumber;
+		}
+	}
+	
+	cache.detected = (cache.l1d > 0 && cache.l2 > 0 && cache.llc > 0);
+	
+	if (cache.l1d == 0)
+		cache.l1d = FALLBACK_L1D_SIZE;
+	if (cache.l2 == 0)
+		cache.l2 = FALLBACK_L2_SIZE;
+	if (cache.llc == 0)
+		cache.llc = std::max(FALLBACK_LLC_SIZE, cache.l2);
+	
+	return cache;
+}
+
+
+CacheInfo getCacheInfo()
+{
+	static CacheInfo cache = detectCacheInfo();
+	
+	return cache;
+}
+
+
+size_t getDefaultTileSize(CacheInfo* cache)
+{
+	/* Half of L2 for the tile and half for the scratch space its runs are merged through */
+	
+	return std::max<size_t>(1024, cache->l2 / 2 / sizeof(int32_t));
+}
+
+
+size_t getDefaultMergeWays(CacheInfo* cache)
+{
+	return std::clamp(cache->l2 / MERGE_RUN_WINDOW, MIN_MERGE_WAYS, MAX_MERGE_WAYS);
+}
@@ -0,0 +1,57 @@
+/**
+*  CacheInfo.hpp
+*
+*  Declares the CPU cache size detection used to size cache-blocked sorts
+*/
+
+#ifndef CACHE_INFO_HPP_MULTITHREADED_SORTING
+#define CACHE_INFO_HPP_MULTITHREADED_SORTING
+
+
+#include <cstddef>
+
+
+/*** Constants ***/
+
+// Used when the sizes cannot be read from /sys
+//
+const size_t FALLBACK_L1D_SIZE = 32 << 10;
+const size_t FALLBACK_L2_SIZE = 256 << 10;
+const size_t FALLBACK_LLC_SIZE = 8 << 20;
+
+const size_t MERGE_RUN_WINDOW = 16 << 10;	// L2 bytes given to each input run of a multi-way merge
+const size_t MIN_MERGE_WAYS = 2;
+const size_t MAX_MERGE_WAYS = 32;
+
+
+
+/*** Data Structures ***/
+
+struct CacheInfo
+{
+	size_t l1d{};	// In bytes
+	size_t l2{};
+	size_t llc{};	// Last level cache
+	
+	bool detected{};	// False if any of the sizes are the fallback values
+};
+
+
+
+/*** Function Declarations ***/
+
+// Reads the cache sizes of cpu0 from /sys/devices/system/cpu/cpu0/cache (only once, later calls return
+// the same values)
+//
+CacheInfo getCacheInfo();
+
+// Gets the number of int32_t values in a tile that fits in L2 together with its merge scratch space
+//
+size_t getDefaultTileSize(CacheInfo* cache);
+
+// Gets the number of runs merged at once so that every run has a MERGE_RUN_WINDOW sized window in L2
+//
+size_t getDefaultMergeWays(CacheInfo* cache);
+
+
+#endif
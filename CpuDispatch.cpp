@@ -0,0 +1,613 @@
+/**
+*  CpuDispatch.cpp
+*
+*  Defines the hot kernels that are built for several instruction sets, and the CPU feature detection
+*  that picks one of them at startup
+*/
+
+#include "CpuDispatch.hpp"
+
+#include <algorithm>
+
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_DISPATCH_X86 1
+#else
+#define CPU_DISPATCH_X86 0
+#endif
+
+#if CPU_DISPATCH_X86
+#include <immintrin.h>
+#endif
+
+
+
+/*** Kernel Bodies ***/
+
+// Each body is written once and forced inline into one wrapper per instruction set below, so the
+// compiler (this file is built with -O3) generates and vectorizes a separate copy for each of them
+
+#define KERNEL_BODY static inline __attribute__((always_inline))
+
+
+KERNEL_BODY void mergeBody(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out)
+{
+	size_t i = 0;
+	size_t j = 0;
+	
+	/* The next value is picked with a conditional move instead of a branch the CPU would mispredict
+	   on random data. Taking from 'a' on ties keeps the merge stable */
+	
+	while (i < na && j < nb)
+	{
+		int32_t x = a[i];
+		int32_t y = b[j];
+		bool takeB = y < x;
+		
+		*out++ = (takeB) ? y : x;
+		
+		j += takeB;
+		i += !takeB;
+	}
+	
+	out = std::copy(a + i, a + na, out);
+	std::copy(b + j, b + nb, out);
+}
+
+
+KERNEL_BODY void countAroundPivotBody(const int32_t* arr, size_t n, int32_t pivot, size_t* counts)
+{
+	size_t less = 0;
+	size_t equal = 0;
+	
+	for (size_t i = 0; i < n; i++)
+	{
+		less += (arr[i] < pivot);
+		equal += (arr[i] == pivot);
+	}
+	
+	counts[0] = less;
+	counts[1] = equal;
+	counts[2] = n - less - equal;
+}
+
+
+KERNEL_BODY size_t partitionBody(int32_t* arr, size_t n)
+{
+	int32_t pivot = arr[n - 1];
+	size_t i = 0;
+	
+	/* Every value is swapped with the first one not less than the pivot, and the boundary only moves past
+	   the values that are less, so the loop has no branch on the comparison */
+	
+	for (size_t j = 0; j + 1 < n; j++)
+	{
+		int32_t value = arr[j];
+		
+		arr[j] = arr[i];
+		arr[i] = value;
+		
+		i += (value < pivot);
+	}
+	
+	std::swap(arr[i], arr[n - 1]);
+	
+	return i;
+}
+
+
+KERNEL_BODY void partition3Body(int32_t* arr, size_t n, size_t* lt, size_t* gt)
+{
+	int64_t high = n - 1;
+	int32_t pivot = arr[high];
+	
+	int64_t i = -1;
+	int64_t j = high;
+	int64_t p = -1;
+	int64_t q = high;
+	
+	while (true)
+	{
+		while (arr[++i] < pivot)
+			;
+		
+		while (pivot < arr[--j])
+		{
+			if (j == 0)
+				break;
+		}
+		
+		if (i >= j)
+			break;
+		
+		std::swap(arr[i], arr[j]);
+		
+		if (arr[i] == pivot)
+			std::swap(arr[++p], arr[i]);
+		if (arr[j] == pivot)
+			std::swap(arr[--q], arr[j]);
+	}
+	
+	std::swap(arr[i], arr[high]);
+	
+	/* If the scan stopped on a key equal to the pivot before the equal keys on the right, that key is now
+	   last, next to them */
+	
+	int64_t last = (i < q && arr[high] == pivot) ? high : high - 1;
+	
+	/* Move the equal keys from the ends to either side of the pivot */
+	
+	j = i - 1;
+	i = i + 1;
+	
+	for (int64_t k = 0; k <= p; k++, j--)
+		std::swap(arr[k], arr[j]);
+	for (int64_t k = last; k >= q; k--, i++)
+		std::swap(arr[k], arr[i]);
+	
+	*lt = j + 1;
+	*gt = i - 1;
+}
+
+
+KERNEL_BODY void smallSortBody(int32_t* begin, int32_t* end)
+{
+	for (int32_t* i = begin + 1; i < end; i++)
+	{
+		int32_t value = *i;
+		int32_t* j = i;
+		
+		while (j > begin && *(j - 1) > value)
+		{
+			*j = *(j - 1);
+			j--;
+		}
+		
+		*j = value;
+	}
+}
+
+
+KERNEL_BODY void countDigitsBody(const uint64_t* src, size_t n, int shift, size_t buckets, size_t* counts)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		counts[(src[i] >> shift) & (buckets - 1)]++;
+	}
+}
+
+
+KERNEL_BODY void scatterDigitsBody(const uint64_t* src, uint64_t* dst, size_t n, int shift, size_t buckets, size_t* offsets)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		dst[offsets[(src[i] >> shift) & (buckets - 1)]++] = src[i];
+	}
+}
+
+
+KERNEL_BODY bool parseIntegersBody(const char* text, size_t length, std::vector<int32_t>* out)
+{
+	size_t i = 0;
+	
+	while (i < length)
+	{
+		char c = text[i];
+		
+		if (c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f')
+		{
+			i++;
+			continue;
+		}
+		
+		bool negative = false;
+		
+		if (c == '-' || c == '+')
+		{
+			negative = (c == '-');
+			i++;
+		}
+		
+		size_t first = i;
+		int64_t value = 0;
+		
+		while (i < length && text[i] >= '0' && text[i] <= '9')
+		{
+			value = value * 10 + (text[i] - '0');
+			i++;
+			
+			if (value > (int64_t)INT32_MAX + 1)
+				return false;
+		}
+		
+		/* A number needs digits and has to end at whitespace or at the end of the text */
+		
+		if (i == first || (i < length && text[i] != ' ' && text[i] != '\n' && text[i] != '\t' && text[i] != '\r' && text[i] != '\v' && text[i] != '\f'))
+			return false;
+		
+		if (!negative && value > INT32_MAX)
+			return false;
+		
+		out->push_back((int32_t)((negative) ? -value : value));
+	}
+	
+	return true;
+}
+
+
+
+/*** Vector Merge ***/
+
+// The merge is the one kernel the compiler cannot vectorize by itself, so the vector paths use a bitonic
+// merge network: two sorted registers in, the smallest half of their values out (sorted) and the largest
+// half kept for the next step. Values are plain integers, so the order of equal values cannot be seen
+
+#if CPU_DISPATCH_X86
+
+#define TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,bmi,bmi2,popcnt")))
+
+
+// Sorts a bitonic register by comparing the lanes 2, then 1 apart
+//
+TARGET_SSE42 KERNEL_BODY __m128i bitonicCleanSSE42(__m128i v)
+{
+	__m128i s = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	v = _mm_blend_epi16(_mm_min_epi32(v, s), _mm_max_epi32(v, s), 0xF0);
+	
+	s = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+	v = _mm_blend_epi16(_mm_min_epi32(v, s), _mm_max_epi32(v, s), 0xCC);
+	
+	return v;
+}
+
+
+// Merges the sorted registers 'lo' and 'hi' into the sorted smallest half ('lo') and largest half ('hi')
+//
+TARGET_SSE42 KERNEL_BODY void mergeNetworkSSE42(__m128i* lo, __m128i* hi)
+{
+	__m128i reversed = _mm_shuffle_epi32(*hi, _MM_SHUFFLE(0, 1, 2, 3));
+	
+	*hi = bitonicCleanSSE42(_mm_max_epi32(*lo, reversed));
+	*lo = bitonicCleanSSE42(_mm_min_epi32(*lo, reversed));
+}
+
+
+TARGET_AVX2 KERNEL_BODY __m256i bitonicCleanAVX2(__m256i v)
+{
+	__m256i s = _mm256_permute2x128_si256(v, v, 0x01);
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, s), _mm256_max_epi32(v, s), 0xF0);
+	
+	s = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, s), _mm256_max_epi32(v, s), 0xCC);
+	
+	s = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, s), _mm256_max_epi32(v, s), 0xAA);
+	
+	return v;
+}
+
+
+TARGET_AVX2 KERNEL_BODY void mergeNetworkAVX2(__m256i* lo, __m256i* hi)
+{
+	__m256i reversed = _mm256_permutevar8x32_epi32(*hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+	
+	*hi = bitonicCleanAVX2(_mm256_max_epi32(*lo, reversed));
+	*lo = bitonicCleanAVX2(_mm256_min_epi32(*lo, reversed));
+}
+
+
+TARGET_AVX512 KERNEL_BODY __m512i bitonicCleanAVX512(__m512i v)
+{
+	const __m512i swap8 = _mm512_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);
+	const __m512i swap4 = _mm512_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11);
+	
+	__m512i s = _mm512_permutexvar_epi32(swap8, v);
+	v = _mm512_mask_blend_epi32(0xFF00, _mm512_min_epi32(v, s), _mm512_max_epi32(v, s));
+	
+	s = _mm512_permutexvar_epi32(swap4, v);
+	v = _mm512_mask_blend_epi32(0xF0F0, _mm512_min_epi32(v, s), _mm512_max_epi32(v, s));
+	
+	s = _mm512_shuffle_epi32(v, _MM_PERM_BADC);
+	v = _mm512_mask_blend_epi32(0xCCCC, _mm512_min_epi32(v, s), _mm512_max_epi32(v, s));
+	
+	s = _mm512_shuffle_epi32(v, _MM_PERM_CDAB);
+	v = _mm512_mask_blend_epi32(0xAAAA, _mm512_min_epi32(v, s), _mm512_max_epi32(v, s));
+	
+	return v;
+}
+
+
+TARGET_AVX512 KERNEL_BODY void mergeNetworkAVX512(__m512i* lo, __m512i* hi)
+{
+	const __m512i reverse = _mm512_setr_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	
+	__m512i reversed = _mm512_permutexvar_epi32(reverse, *hi);
+	
+	*hi = bitonicCleanAVX512(_mm512_max_epi32(*lo, reversed));
+	*lo = bitonicCleanAVX512(_mm512_min_epi32(*lo, reversed));
+}
+
+#endif
+
+
+// Defines the merge of one instruction set. The register of largest values is merged with the next
+// LANES values of the run whose next value is smaller, which keeps every value written no larger than
+// the ones left. The loop stops when that run has less than a register left, so no sentinels are needed:
+// the held register and the short run are merged into a small buffer, and that buffer with the other run
+//
+#define DEFINE_VECTOR_MERGE(SUFFIX, TARGET, LANES, VECTOR, LOAD, STORE)															\
+	TARGET static void merge##SUFFIX(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out)					\
+	{																															\
+		if (na < LANES || nb < LANES)																							\
+		{																														\
+			mergeBody(a, na, b, nb, out);																						\
+			return;																												\
+		}																														\
+																																\
+		VECTOR lo = LOAD((const VECTOR*)a);																						\
+		VECTOR hi = LOAD((const VECTOR*)b);																						\
+		size_t i = LANES;																										\
+		size_t j = LANES;																										\
+																																\
+		while (true)																											\
+		{																														\
+			mergeNetwork##SUFFIX(&lo, &hi);																						\
+			STORE((VECTOR*)out, lo);																							\
+			out += LANES;																										\
+																																\
+			if (i < na && (j >= nb || a[i] <= b[j]))																			\
+			{																													\
+				if (i + LANES > na)																								\
+					break;																										\
+				lo = LOAD((const VECTOR*)(a + i));																				\
+				i += LANES;																										\
+			}																													\
+			else if (j < nb && j + LANES <= nb)																					\
+			{																													\
+				lo = LOAD((const VECTOR*)(b + j));																				\
+				j += LANES;																										\
+			}																													\
+			else																												\
+				break;																											\
+		}																														\
+																																\
+		int32_t held[LANES];																									\
+		int32_t buffer[2 * LANES];																								\
+		STORE((VECTOR*)held, hi);																								\
+																																\
+		bool shortA = (na - i < LANES);																							\
+		const int32_t* shortRun = (shortA) ? a + i : b + j;																		\
+		size_t shortLength = (shortA) ? na - i : nb - j;																		\
+																																\
+		mergeBody(held, LANES, shortRun, shortLength, buffer);																	\
+		mergeBody(buffer, LANES + shortLength, (shortA) ? b + j : a + i, (shortA) ? nb - j : na - i, out);						\
+	}
+
+
+static void mergeScalar(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out)
+{
+	mergeBody(a, na, b, nb, out);
+}
+
+#if CPU_DISPATCH_X86
+DEFINE_VECTOR_MERGE(SSE42, TARGET_SSE42, 4, __m128i, _mm_loadu_si128, _mm_storeu_si128)
+DEFINE_VECTOR_MERGE(AVX2, TARGET_AVX2, 8, __m256i, _mm256_loadu_si256, _mm256_storeu_si256)
+DEFINE_VECTOR_MERGE(AVX512, TARGET_AVX512, 16, __m512i, _mm512_loadu_si512, _mm512_storeu_si512)
+#endif
+
+
+
+/*** Kernel Variants ***/
+
+struct KernelTable
+{
+	void (*merge)(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out);
+	void (*countAroundPivot)(const int32_t* arr, size_t n, int32_t pivot, size_t* counts);
+	size_t (*partition)(int32_t* arr, size_t n);
+	void (*partition3)(int32_t* arr, size_t n, size_t* lt, size_t* gt);
+	void (*smallSort)(int32_t* begin, int32_t* end);
+	void (*countDigits)(const uint64_t* src, size_t n, int shift, size_t buckets, size_t* counts);
+	void (*scatterDigits)(const uint64_t* src, uint64_t* dst, size_t n, int shift, size_t buckets, size_t* offsets);
+	bool (*parseIntegers)(const char* text, size_t length, std::vector<int32_t>* out);
+};
+
+
+// Defines the wrappers of every other kernel for one instruction set, and the table that points to them
+//
+#define DEFINE_KERNEL_VARIANTS(SUFFIX, TARGET)																					\
+	TARGET static void countAroundPivot##SUFFIX(const int32_t* arr, size_t n, int32_t pivot, size_t* counts)					\
+		{ countAroundPivotBody(arr, n, pivot, counts); }																		\
+	TARGET static size_t partition##SUFFIX(int32_t* arr, size_t n)																\
+		{ return partitionBody(arr, n); }																						\
+	TARGET static void partition3##SUFFIX(int32_t* arr, size_t n, size_t* lt, size_t* gt)										\
+		{ partition3Body(arr, n, lt, gt); }																					\
+	TARGET static void smallSort##SUFFIX(int32_t* begin, int32_t* end)															\
+		{ smallSortBody(begin, end); }																							\
+	TARGET static void countDigits##SUFFIX(const uint64_t* src, size_t n, int shift, size_t buckets, size_t* counts)			\
+		{ countDigitsBody(src, n, shift, buckets, counts); }																	\
+	TARGET static void scatterDigits##SUFFIX(const uint64_t* src, uint64_t* dst, size_t n, int shift, size_t buckets, size_t* offsets)	\
+		{ scatterDigitsBody(src, dst, n, shift, buckets, offsets); }															\
+	TARGET static bool parseIntegers##SUFFIX(const char* text, size_t length, std::vector<int32_t>* out)						\
+		{ return parseIntegersBody(text, length, out); }																		\
+	static const KernelTable kernels##SUFFIX = { merge##SUFFIX, countAroundPivot##SUFFIX, partition##SUFFIX, partition3##SUFFIX,	\
+	                                             smallSort##SUFFIX, countDigits##SUFFIX, scatterDigits##SUFFIX, parseIntegers##SUFFIX };
+
+
+DEFINE_KERNEL_VARIANTS(Scalar, )
+
+#if CPU_DISPATCH_X86
+DEFINE_KERNEL_VARIANTS(SSE42, TARGET_SSE42)
+DEFINE_KERNEL_VARIANTS(AVX2, TARGET_AVX2)
+DEFINE_KERNEL_VARIANTS(AVX512, TARGET_AVX512)
+#endif
+
+
+
+/*** Dispatch ***/
+
+static const KernelTable* getKernelTable(CpuPath path)
+{
+#if CPU_DISPATCH_X86
+	switch (path)
+	{
+		case CpuPath::SSE42:
+			return &kernelsSSE42;
+		case CpuPath::AVX2:
+			return &kernelsAVX2;
+		case CpuPath::AVX512:
+			return &kernelsAVX512;
+		default:
+			break;
+	}
+#endif
+	
+	return &kernelsScalar;
+}
+
+
+// Checks if the CPU can run 'path'
+//
+static bool isCpuPathSupported(CpuPath path)
+{
+#if CPU_DISPATCH_X86
+	__builtin_cpu_init();
+	
+	switch (path)
+	{
+		case CpuPath::SSE42:
+			return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+		case CpuPath::AVX2:
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+		case CpuPath::AVX512:
+			return __builtin_cpu_supports("avx512f") && isCpuPathSupported(CpuPath::AVX2);
+		default:
+			return true;
+	}
+#else
+	return path == CpuPath::Scalar;
+#endif
+}
+
+
+CpuPath detectCpuPath()
+{
+	const CpuPath paths[] = { CpuPath::AVX512, CpuPath::AVX2, CpuPath::SSE42 };
+	
+	for (CpuPath path : paths)
+	{
+		if (isCpuPathSupported(path))
+			return path;
+	}
+	
+	return CpuPath::Scalar;
+}
+
+
+static CpuPath activePath = detectCpuPath();
+static const KernelTable* activeKernels = getKernelTable(activePath);
+
+
+CpuPath getCpuPath()
+{
+	return activePath;
+}
+
+
+bool setCpuPath(CpuPath path)
+{
+	if (!isCpuPathSupported(path))
+		return false;
+	
+	activePath = path;
+	activeKernels = getKernelTable(path);
+	
+	return true;
+}
+
+
+std::string getCpuPathName(CpuPath path)
+{
+	switch (path)
+	{
+		case CpuPath::Scalar:
+			return "scalar";
+		case CpuPath::SSE42:
+			return "sse4.2";
+		case CpuPath::AVX2:
+			return "avx2";
+		case CpuPath::AVX512:
+			return "avx512";
+		default:
+			return "";
+	}
+}
+
+
+bool parseCpuPathName(std::string name, CpuPath* path)
+{
+	const CpuPath paths[] = { CpuPath::Scalar, CpuPath::SSE42, CpuPath::AVX2, CpuPath::AVX512 };
+	
+	for (CpuPath p : paths)
+	{
+		if (name == getCpuPathName(p))
+		{
+			*path = p;
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+
+/*** Kernels ***/
+
+void mergeKernel(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out)
+{
+	activeKernels->merge(a, na, b, nb, out);
+}
+
+
+void countAroundPivotKernel(const int32_t* arr, size_t n, int32_t pivot, size_t* counts)
+{
+	activeKernels->countAroundPivot(arr, n, pivot, counts);
+}
+
+
+size_t partitionKernel(int32_t* arr, size_t n)
+{
+	return activeKernels->partition(arr, n);
+}
+
+
+void partition3Kernel(int32_t* arr, size_t n, size_t* lt, size_t* gt)
+{
+	activeKernels->partition3(arr, n, lt, gt);
+}
+
+
+void smallSortKernel(int32_t* begin, int32_t* end)
+{
+	activeKernels->smallSort(begin, end);
+}
+
+
+void countDigitsKernel(const uint64_t* src, size_t n, int shift, size_t buckets, size_t* counts)
+{
+	activeKernels->countDigits(src, n, shift, buckets, counts);
+}
+
+
+void scatterDigitsKernel(const uint64_t* src, uint64_t* dst, size_t n, int shift, size_t buckets, size_t* offsets)
+{
+	activeKernels->scatterDigits(src, dst, n, shift, buckets, offsets);
+}
+
+
+bool parseIntegersKernel(const char* text, size_t length, std::vector<int32_t>* out)
+{
+	return activeKernels->parseIntegers(text, length, out);
+}
@@ -0,0 +1,92 @@
+/**
+*  CpuDispatch.hpp
+*
+*  Declares the hot kernels that are built for several instruction sets, and the CPU feature detection
+*  that picks one of them at startup
+*/
+
+#ifndef CPU_DISPATCH_HPP_MULTITHREADED_SORTING
+#define CPU_DISPATCH_HPP_MULTITHREADED_SORTING
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+/*** Data Structures ***/
+
+enum class CpuPath
+{
+	Scalar,		// Baseline x86-64 (SSE2) or a non-x86 CPU
+	SSE42,
+	AVX2,
+	AVX512		// AVX-512 Foundation
+};
+
+
+
+/*** Function Declarations ***/
+
+// Gets the best path the CPU supports, from CPUID
+//
+CpuPath detectCpuPath();
+
+// Gets the path the kernels currently run on (the detected one unless setCpuPath() chose another)
+//
+CpuPath getCpuPath();
+
+// Makes the kernels run on 'path'. Returns false, leaving the path unchanged, if the CPU does not support it
+//
+bool setCpuPath(CpuPath path);
+
+// Gets the command line name of 'path' (ex. "avx2")
+//
+std::string getCpuPathName(CpuPath path);
+
+// Converts a command line name <scalar|sse4.2|avx2|avx512> to a CpuPath. Returns false if it is unknown
+//
+bool parseCpuPathName(std::string name, CpuPath* path);
+
+
+/* Kernels, each one runs the variant built for the current path */
+
+// Merges the sorted runs a[0..na) and b[0..nb) into 'out' without branching on the comparisons, through
+// a bitonic merge network of 4, 8 or 16 lanes on the vector paths
+//
+void mergeKernel(const int32_t* a, size_t na, const int32_t* b, size_t nb, int32_t* out);
+
+// Counts the values of arr[0..n) that are less than, equal to and greater than 'pivot' into counts[0..2]
+//
+void countAroundPivotKernel(const int32_t* arr, size_t n, int32_t pivot, size_t* counts);
+
+// Lomuto partition of arr[0..n) around arr[n - 1] without branching on the comparisons. Returns the final
+// position of the pivot, with the smaller values before it and the rest after it
+//
+size_t partitionKernel(int32_t* arr, size_t n);
+
+// Three-way (Bentley-McIlroy) partition of arr[0..n) around arr[n - 1]. Afterwards arr[0..lt) < pivot,
+// arr[lt..gt] == pivot and arr(gt..n) > pivot, so callers can skip the equal band
+//
+void partition3Kernel(int32_t* arr, size_t n, size_t* lt, size_t* gt);
+
+// Insertion sorts [begin..end), meant for the few dozen values at the bottom of the merge sorts
+//
+void smallSortKernel(int32_t* begin, int32_t* end);
+
+// Adds the radix digits ((value >> shift) & (buckets - 1)) of src[0..n) to 'counts'
+//
+void countDigitsKernel(const uint64_t* src, size_t n, int shift, size_t buckets, size_t* counts);
+
+// Moves src[0..n) to 'dst' using the running bucket positions in 'offsets'
+//
+void scatterDigitsKernel(const uint64_t* src, uint64_t* dst, size_t n, int shift, size_t buckets, size_t* offsets);
+
+// Parses the whitespace separated integers in text[0..length) and appends them to 'out'. 'text' must end
+// with whitespace or at the end of the input. Returns false on anything that is not a 32-bit integer
+//
+bool parseIntegersKernel(const char* text, size_t length, std::vector<int32_t>* out);
+
+
+#endif
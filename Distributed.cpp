@@ -0,0 +1,647 @@
+/**
+*  Distributed.cpp
+*
+*  Defines the multi-process sort, which splits the data over local worker processes the way it would
+*  be split over the nodes of a cluster, and measures each phase of it
+*/
+
+#include "Distributed.hpp"
+#include "CpuDispatch.hpp"
+#include "Stopwatch.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+
+/*** Data Structures ***/
+
+// What one worker measured, written to shared memory for the coordinator
+//
+struct WorkerStats
+{
+	double seconds[(int)DistributedPhase::Count];
+	size_t bytes[(int)DistributedPhase::Count];
+	size_t localBytes[(int)DistributedPhase::Count];
+	size_t messages[(int)DistributedPhase::Count];
+};
+
+// Memory shared by the coordinator and every worker. It is mapped before the workers are forked, so
+// the pointers are the same in every process
+//
+struct SharedRegion
+{
+	int32_t numProcesses{};
+	size_t dataLength{};
+	
+	int32_t* input{};		// The blocks, sorted in place by their workers
+	int32_t* output{};		// The shards, in order
+	size_t* counts{};		// counts[i * numProcesses + j]: values of block i that belong to shard j
+	WorkerStats* stats{};
+};
+
+
+
+/*** Function Definitions ***/
+
+std::string getDistributedPhaseName(DistributedPhase phase)
+{
+	switch (phase)
+	{
+		case DistributedPhase::Partition:
+			return "Partition";
+		case DistributedPhase::LocalSort:
+			return "Local Sort";
+		case DistributedPhase::Sampling:
+			return "Sampling";
+		case DistributedPhase::Splitters:
+			return "Splitters";
+		case DistributedPhase::Exchange:
+			return "Exchange";
+		case DistributedPhase::Merge:
+			return "Merge";
+		default:
+			return "";
+	}
+}
+
+
+// Maps 'size' bytes of memory that forked processes share
+//
+static void* mapShared(size_t size)
+{
+	void* memory = mmap(nullptr, std::max<size_t>(size, 1), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	
+	return (memory == MAP_FAILED) ? nullptr : memory;
+}
+
+
+static void unmapShared(void* memory, size_t size)
+{
+	if (memory != nullptr)
+		munmap(memory, std::max<size_t>(size, 1));
+}
+
+
+bool sendAll(int fd, const void* data, size_t size)
+{
+	const char* bytes = (const char*)data;
+	
+	while (size > 0)
+	{
+		ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+		
+		if (sent < 0 && errno == EINTR)
+			continue;
+		else if (sent <= 0)
+			return false;
+		
+		bytes += sent;
+		size -= sent;
+	}
+	
+	return true;
+}
+
+bool recvAll(int fd, void* data, size_t size)
+{
+	char* bytes = (char*)data;
+	
+	while (size > 0)
+	{
+		ssize_t received = recv(fd, bytes, size, 0);
+		
+		if (received < 0 && errno == EINTR)
+			continue;
+		else if (received <= 0)
+			return false;
+		
+		bytes += received;
+		size -= received;
+	}
+	
+	return true;
+}
+
+
+// Gets the first position of block 'block' in the input
+//
+static size_t getBlockStart(SharedRegion* shared, int32_t block)
+{
+	size_t blockSize = (shared->dataLength + shared->numProcesses - 1) / shared->numProcesses;
+	
+	return std::min(block * blockSize, shared->dataLength);
+}
+
+
+// Merges the sorted runs of src, which start at 'starts' (with the end as the last entry), two at a time
+// until one is left. Returns the buffer holding the result, 'src' or 'dst'
+//
+static int32_t* mergeRuns(int32_t* src, int32_t* dst, std::vector<size_t> starts)
+{
+	while (starts.size() > 2)
+	{
+		std::vector<size_t> merged;
+		
+		for (size_t r = 0; r + 1 < starts.size(); r += 2)
+		{
+			merged.push_back(starts[r]);
+			
+			if (r + 2 < starts.size())
+				mergeKernel(src + starts[r], starts[r + 1] - starts[r], src + starts[r + 1], starts[r + 2] - starts[r + 1], dst + starts[r]);
+			else
+				std::copy(src + starts[r], src + starts[r + 1], dst + starts[r]);
+		}
+		
+		merged.push_back(starts.back());
+		
+		starts.swap(merged);
+		std::swap(src, dst);
+	}
+	
+	return src;
+}
+
+
+// Runs worker 'w' from its local sort to its finished shard, talking to the coordinator over 'fd'
+//
+static bool runWorker(SortParameters* param, SharedRegion* shared, int32_t w, int fd)
+{
+	int32_t numProcesses = shared->numProcesses;
+	WorkerStats* stats = &(shared->stats[w]);
+	
+	size_t begin = getBlockStart(shared, w);
+	size_t end = getBlockStart(shared, w + 1);
+	size_t length = end - begin;
+	
+	Stopwatch timer;
+	
+	
+	/* Local Sort: the same engines a single process run uses, on this block */
+	
+	timer.start();
+	
+	param->data.assign(shared->input + begin, shared->input + end);
+	
+	runSortingAlgorithm(param);
+	
+	std::copy(param->data.begin(), param->data.end(), shared->input + begin);
+	
+	std::vector<int32_t>().swap(param->data);
+	
+	timer.stop();
+	stats->seconds[(int)DistributedPhase::LocalSort] = timer.getSeconds();
+	
+	
+	/* Sampling: regularly spaced values of the sorted block */
+	
+	timer.reset();
+	timer.start();
+	
+	uint64_t numSamples = std::min<size_t>(SAMPLES_PER_PROCESS, length);
+	std::vector<int32_t> samples(numSamples);
+	
+	for (size_t s = 0; s < numSamples; s++)
+	{
+		samples[s] = shared->input[begin + (s + 1) * length / (numSamples + 1)];
+	}
+	
+	if (!sendAll(fd, &numSamples, sizeof(numSamples)) || !sendAll(fd, samples.data(), numSamples * sizeof(int32_t)))
+		return false;
+	
+	timer.stop();
+	stats->seconds[(int)DistributedPhase::Sampling] = timer.getSeconds();
+	stats->bytes[(int)DistributedPhase::Sampling] = sizeof(numSamples) + numSamples * sizeof(int32_t);
+	stats->messages[(int)DistributedPhase::Sampling] = 1;
+	
+	std::vector<int32_t> splitters(numProcesses - 1);
+	
+	if (!recvAll(fd, splitters.data(), splitters.size() * sizeof(int32_t)))
+		return false;
+	
+	
+	/* Exchange: publish how the block splits over the shards, wait until every block has, then fetch
+	   this shard's part of every block */
+	
+	timer.reset();
+	timer.start();
+	
+	size_t* counts = shared->counts + (size_t)w * numProcesses;
+	size_t position = begin;
+	
+	for (int32_t j = 0; j < numProcesses; j++)
+	{
+		size_t next = (j < numProcesses - 1) ? std::upper_bound(shared->input + position, shared->input + end, splitters[j]) - shared->input : end;
+		
+		counts[j] = next - position;
+		position = next;
+	}
+	
+	char message = 1;
+	
+	if (!sendAll(fd, &message, 1) || !recvAll(fd, &message, 1))
+		return false;
+	
+	size_t shardStart = 0;
+	size_t shardLength = 0;
+	
+	for (int32_t i = 0; i < numProcesses; i++)
+	{
+		for (int32_t j = 0; j < w; j++)
+		{
+			shardStart += shared->counts[(size_t)i * numProcesses + j];
+		}
+		
+		shardLength += shared->counts[(size_t)i * numProcesses + w];
+	}
+	
+	std::vector<int32_t> runs(shardLength);
+	std::vector<size_t> runStarts;
+	size_t filled = 0;
+	
+	for (int32_t i = 0; i < numProcesses; i++)
+	{
+		size_t* blockCounts = shared->counts + (size_t)i * numProcesses;
+		size_t offset = getBlockStart(shared, i);
+		
+		for (int32_t j = 0; j < w; j++)
+		{
+			offset += blockCounts[j];
+		}
+		
+		runStarts.push_back(filled);
+		
+		std::copy(shared->input + offset, shared->input + offset + blockCounts[w], runs.data() + filled);
+		
+		filled += blockCounts[w];
+		
+		if (i == w)
+			stats->localBytes[(int)DistributedPhase::Exchange] += blockCounts[w] * sizeof(int32_t);
+		else
+			stats->bytes[(int)DistributedPhase::Exchange] += blockCounts[w] * sizeof(int32_t);
+	}
+	
+	runStarts.push_back(filled);
+	
+	timer.stop();
+	stats->seconds[(int)DistributedPhase::Exchange] = timer.getSeconds();
+	stats->messages[(int)DistributedPhase::Exchange] = 1;
+	
+	
+	/* Merge: one sorted run per block into the shard */
+	
+	timer.reset();
+	timer.start();
+	
+	std::vector<int32_t> scratch(shardLength);
+	
+	int32_t* merged = mergeRuns(runs.data(), scratch.data(), runStarts);
+	
+	std::copy(merged, merged + shardLength, shared->output + shardStart);
+	
+	timer.stop();
+	stats->seconds[(int)DistributedPhase::Merge] = timer.getSeconds();
+	stats->localBytes[(int)DistributedPhase::Merge] = shardLength * sizeof(int32_t);
+	
+	return sendAll(fd, &message, 1);
+}
+
+
+// Stops the workers that are still running and waits for all of them
+//
+static void stopWorkers(std::vector<pid_t>* workers, std::vector<int>* sockets)
+{
+	for (int fd : *sockets)
+	{
+		close(fd);
+	}
+	
+	for (pid_t pid : *workers)
+	{
+		kill(pid, SIGKILL);
+		waitpid(pid, nullptr, 0);
+	}
+}
+
+
+bool runDistributedSort(SortParameters* param, int32_t numProcesses, DistributedResult* result)
+{
+	size_t n = param->data.size();
+	
+	numProcesses = (int32_t)std::max<size_t>(1, std::min<size_t>(numProcesses, n));
+	
+	*result = DistributedResult{};
+	result->processes = numProcesses;
+	result->dataLength = n;
+	
+	Stopwatch wallTimer;
+	wallTimer.start();
+	
+	
+	/* Partition: map the shared memory, copy the input blocks in and start the workers */
+	
+	Stopwatch timer;
+	timer.start();
+	
+	SharedRegion shared;
+	
+	shared.numProcesses = numProcesses;
+	shared.dataLength = n;
+	shared.input = (int32_t*)mapShared(n * sizeof(int32_t));
+	shared.output = (int32_t*)mapShared(n * sizeof(int32_t));
+	shared.counts = (size_t*)mapShared((size_t)numProcesses * numProcesses * sizeof(size_t));
+	shared.stats = (WorkerStats*)mapShared(numProcesses * sizeof(WorkerStats));
+	
+	auto unmapRegion = [&]()
+	{
+		unmapShared(shared.input, n * sizeof(int32_t));
+		unmapShared(shared.output, n * sizeof(int32_t));
+		unmapShared(shared.counts, (size_t)numProcesses * numProcesses * sizeof(size_t));
+		unmapShared(shared.stats, numProcesses * sizeof(WorkerStats));
+	};
+	
+	if (shared.input == nullptr || shared.output == nullptr || shared.counts == nullptr || shared.stats == nullptr)
+	{
+		unmapRegion();
+		
+		result->error = "Cannot map shared memory";
+		return false;
+	}
+	
+	std::copy(param->data.begin(), param->data.end(), shared.input);
+	
+	std::vector<pid_t> workers;
+	std::vector<int> sockets;
+	
+	std::cout.flush();
+	
+	for (int32_t w = 0; w < numProcesses; w++)
+	{
+		int pair[2];
+		
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+		{
+			stopWorkers(&workers, &sockets);
+			unmapRegion();
+			
+			result->error = "Cannot create a Unix domain socket";
+			return false;
+		}
+		
+		pid_t pid = fork();
+		
+		if (pid == 0)
+		{
+			/* Worker: it only needs its own end of its own socket */
+			
+			for (int fd : sockets)
+			{
+				close(fd);
+			}
+			
+			close(pair[0]);
+			
+			bool succeeded = false;
+			
+			try
+			{
+				succeeded = runWorker(param, &shared, w, pair[1]);
+			}
+			catch (...)
+			{
+			}
+			
+			_exit((succeeded) ? 0 : 1);
+		}
+		
+		close(pair[1]);
+		
+		if (pid < 0)
+		{
+			close(pair[0]);
+			stopWorkers(&workers, &sockets);
+			unmapRegion();
+			
+			result->error = "Cannot start worker process " + std::to_string(w);
+			return false;
+		}
+		
+		workers.push_back(pid);
+		sockets.push_back(pair[0]);
+	}
+	
+	timer.stop();
+	
+	PhaseStats* partition = &(result->phases[(int)DistributedPhase::Partition]);
+	
+	partition->seconds = timer.getSeconds();
+	partition->bytes = n * sizeof(int32_t);
+	
+	
+	/* Splitters: every worker sends its samples once its block is sorted, and gets the splitters back */
+	
+	std::vector<int32_t> samples;
+	bool failed = false;
+	
+	for (int32_t w = 0; w < numProcesses && !failed; w++)
+	{
+		uint64_t numSamples;
+		
+		failed = !recvAll(sockets[w], &numSamples, sizeof(numSamples)) || numSamples > SAMPLES_PER_PROCESS;
+		
+		if (!failed)
+		{
+			size_t first = samples.size();
+			
+			samples.resize(first + numSamples);
+			
+			failed = !recvAll(sockets[w], samples.data() + first, numSamples * sizeof(int32_t));
+		}
+	}
+	
+	timer.reset();
+	timer.start();
+	
+	std::sort(samples.begin(), samples.end());
+	
+	std::vector<int32_t> splitters(numProcesses - 1);
+	
+	for (int32_t j = 1; j < numProcesses && !samples.empty(); j++)
+	{
+		splitters[j - 1] = samples[j * samples.size() / numProcesses];
+	}
+	
+	for (int32_t w = 0; w < numProcesses && !failed; w++)
+	{
+		failed = !sendAll(sockets[w], splitters.data(), splitters.size() * sizeof(int32_t));
+	}
+	
+	timer.stop();
+	
+	PhaseStats* splitting = &(result->phases[(int)DistributedPhase::Splitters]);
+	
+	splitting->seconds = timer.getSeconds();
+	splitting->bytes = numProcesses * splitters.size() * sizeof(int32_t);
+	splitting->messages = numProcesses;
+	
+	
+	/* Exchange: once every block is split, let the workers fetch their shards, then wait for them */
+	
+	char message;
+	
+	for (int32_t w = 0; w < numProcesses && !failed; w++)
+	{
+		failed = !recvAll(sockets[w], &message, 1);
+	}
+	
+	for (int32_t w = 0; w < numProcesses && !failed; w++)
+	{
+		failed = !sendAll(sockets[w], &message, 1);
+	}
+	
+	for (int32_t w = 0; w < numProcesses && !failed; w++)
+	{
+		failed = !recvAll(sockets[w], &message, 1);
+	}
+	
+	if (failed)
+	{
+		stopWorkers(&workers, &sockets);
+		unmapRegion();
+		
+		result->error = "A worker process exited before finishing its shard";
+		return false;
+	}
+	
+	for (int fd : sockets)
+	{
+		close(fd);
+	}
+	
+	for (pid_t pid : workers)
+	{
+		int status = 0;
+		
+		waitpid(pid, &status, 0);
+		
+		failed = failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	}
+	
+	if (failed)
+	{
+		unmapRegion();
+		
+		result->error = "A worker process failed";
+		return false;
+	}
+	
+	
+	/* Collect the shards and the workers' measurements */
+	
+	std::copy(shared.output, shared.output + n, param->data.begin());
+	
+	for (int32_t j = 0; j < numProcesses; j++)
+	{
+		size_t shardSize = 0;
+		
+		for (int32_t i = 0; i < numProcesses; i++)
+		{
+			shardSize += shared.counts[(size_t)i * numProcesses + j];
+		}
+		
+		result->shardSizes.push_back(shardSize);
+	}
+	
+	for (int32_t w = 0; w < numProcesses; w++)
+	{
+		WorkerStats* stats = &(shared.stats[w]);
+		
+		for (int p = (int)DistributedPhase::LocalSort; p < (int)DistributedPhase::Count; p++)
+		{
+			if (p == (int)DistributedPhase::Splitters)
+				continue;
+			
+			PhaseStats* phase = &(result->phases[p]);
+			
+			phase->seconds = std::max(phase->seconds, stats->seconds[p]);
+			phase->bytes += stats->bytes[p];
+			phase->localBytes += stats->localBytes[p];
+			phase->messages += stats->messages[p];
+		}
+	}
+	
+	/* The exchange barrier is one message to and one from every worker */
+	
+	result->phases[(int)DistributedPhase::Exchange].messages += numProcesses;
+	
+	unmapRegion();
+	
+	wallTimer.stop();
+	
+	result->wallTime = wallTimer.getSeconds();
+	result->completed = true;
+	
+	return true;
+}
+
+
+bool writeDistributedReport(DistributedResult* result, SortParameters* param, std::string timestamp, bool sortedCorrectly, std::string fileName)
+{
+	std::ofstream report(fileName);
+	
+	if (!report.is_open())
+	{
+		return false;
+	}
+	
+	report << std::fixed << std::setprecision(6);
+	
+	report << "Timestamp         : " << timestamp << "\n";
+	report << "Test Data         : " << param->dataFile << "\n";
+	report << "Data Length       : " << result->dataLength << "\n";
+	report << "Sorting Algorithm : " << getAlgorithmName(param->algorithm) << " (in each worker)\n";
+	report << "Worker Processes  : " << result->processes << "\n";
+	report << "Threads/Process   : " << ((param->parallel) ? param->numThreads : 1) << "\n";
+	report << "Wall Time         : " << result->wallTime << " seconds\n";
+	
+	if (param->verify)
+	{
+		report << "Verification      : " << ((sortedCorrectly) ? "Data was properly sorted" : "Data was NOT properly sorted") << "\n";
+	}
+	
+	report << "\nPhase         Time (s)     Bytes Moved    Local Bytes    Messages\n";
+	
+	for (int p = 0; p < (int)DistributedPhase::Count; p++)
+	{
+		PhaseStats* phase = &(result->phases[p]);
+		
+		report << std::left << std::setw(14) << getDistributedPhaseName((DistributedPhase)p) << std::right
+		       << std::setw(8) << phase->seconds << " "
+		       << std::setw(15) << phase->bytes << " "
+		       << std::setw(14) << phase->localBytes << " "
+		       << std::setw(11) << phase->messages << "\n";
+	}
+	
+	report << "\nTimes are the slowest process of each phase, bytes moved are what the processes would send\n"
+	       << "to each other over a network (Partition counts the input handed out by the coordinator)\n";
+	
+	report << "\nShard Sizes       :";
+	
+	for (size_t shardSize : result->shardSizes)
+	{
+		report << " " << shardSize;
+	}
+	
+	report << "\n";
+	
+	return true;
+}
@@ -0,0 +1,92 @@
+/**
+*  Distributed.hpp
+*
+*  Declares the multi-process sort, which splits the data over local worker processes the way it would
+*  be split over the nodes of a cluster, and measures each phase of it
+*/
+
+#ifndef DISTRIBUTED_HPP_MULTITHREADED_SORTING
+#define DISTRIBUTED_HPP_MULTITHREADED_SORTING
+
+
+#include "SortRunner.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+/*** Constants ***/
+
+const int32_t MIN_NUM_PROCESSES = 2;
+const int32_t MAX_NUM_PROCESSES = 64;
+
+const size_t SAMPLES_PER_PROCESS = 64;		// Sampled values each worker sends for choosing the splitters
+
+
+
+/*** Data Structures ***/
+
+enum class DistributedPhase
+{
+	Partition,		// Coordinator copies the input blocks to shared memory and starts the workers
+	LocalSort,		// Each worker sorts its block with the chosen algorithm
+	Sampling,		// Workers send regular samples of their sorted blocks to the coordinator
+	Splitters,		// Coordinator sorts the samples and sends the global splitters to every worker
+	Exchange,		// Every worker fetches its shard's part of every block
+	Merge,			// Every worker merges the sorted parts into its shard
+	Count
+};
+
+struct PhaseStats
+{
+	double seconds{};		// Slowest process, which is what the phase costs on the critical path
+	size_t bytes{};			// Bytes moved between processes (or into them for Partition)
+	size_t localBytes{};	// Bytes a process moved within its own memory, which a cluster would not send
+	size_t messages{};		// Control messages sent over the sockets
+};
+
+struct DistributedResult
+{
+	int32_t processes{};
+	size_t dataLength{};
+	
+	PhaseStats phases[(int)DistributedPhase::Count];
+	
+	std::vector<size_t> shardSizes;		// Values in each worker's output shard, in shard order
+	
+	double wallTime{};
+	
+	bool completed{};
+	std::string error;		// Why the workers did not complete
+};
+
+
+
+/*** Function Declarations ***/
+
+// Gets the display name of 'phase' (ex. "Local Sort")
+//
+std::string getDistributedPhaseName(DistributedPhase phase);
+
+// Sorts 'param->data' over 'numProcesses' forked worker processes. Each worker sorts one block of the
+// input with the algorithm of 'param' (runSortingAlgorithm), the global splitters are chosen from samples
+// of the sorted blocks, and worker j then merges the values between splitters j-1 and j from every block
+// into output shard j. Blocks and shards live in shared memory, control messages and samples go over Unix
+// domain sockets. 'param->data' is left holding the shards in order. Returns false and sets
+// 'result->error' if a worker failed
+//
+bool runDistributedSort(SortParameters* param, int32_t numProcesses, DistributedResult* result);
+
+// Saves the per-phase time and communication volume of 'result'
+//
+bool writeDistributedReport(DistributedResult* result, SortParameters* param, std::string timestamp, bool sortedCorrectly, std::string fileName);
+
+// Sends or receives exactly 'size' bytes over a socket, retrying short transfers and EINTR. Returns false
+// if the other side is gone. Shared with the sort service
+//
+bool sendAll(int fd, const void* data, size_t size);
+bool recvAll(int fd, void* data, size_t size);
+
+
+#endif
@@ -0,0 +1,284 @@
+/**
+*  MemoryInfo.cpp
+*
+*  Defines the process memory measurements and allocation counting shown in the reports
+*/
+
+#include "MemoryInfo.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+
+/*** Constants ***/
+
+const size_t HUGE_PAGE_SIZE = 2 << 20;
+const size_t HUGE_PAGE_MIN_ALLOCATION = 4 << 20;	// Smaller allocations stay with plain malloc
+
+
+
+/*** Allocation Counting ***/
+
+// Updated by every operator new/delete in the program. Relaxed atomics are enough since the values are
+// only read after the threads of a measured section have been joined
+//
+static std::atomic<size_t> allocationCount{0};
+static std::atomic<size_t> allocatedBytes{0};
+static std::atomic<size_t> heapInUse{0};
+static std::atomic<size_t> peakHeapInUse{0};
+static std::atomic<size_t> hugePageAllocationCount{0};
+
+static std::atomic<bool> hugePageBuffers{true};
+
+
+// Allocates a large buffer on a 2 MB boundary and asks the kernel to back it with transparent huge pages,
+// which cuts the TLB misses of sweeping through data and scratch buffers of several gigabytes. Returns
+// nullptr if the aligned allocation fails, so the caller can fall back to malloc
+//
+static void* hugePageAllocate(size_t size)
+{
+	size_t rounded = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+	
+	void* ptr = aligned_alloc(HUGE_PAGE_SIZE, rounded);
+	
+	if (ptr != nullptr)
+	{
+		/* Only a hint: kernels without THP (or with it set to "never") return an error that is ignored */
+		
+		madvise(ptr, rounded, MADV_HUGEPAGE);
+		
+		hugePageAllocationCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	
+	return ptr;
+}
+
+
+// Allocates 'size' bytes with malloc (huge page aligned when large) and counts them. The usable size is what is added to the heap in
+// use, so that operator delete (which is not always told the size) can subtract the same amount
+//
+static void* countedAllocate(size_t size)
+{
+	void* ptr = nullptr;
+	
+	if (size >= HUGE_PAGE_MIN_ALLOCATION && hugePageBuffers.load(std::memory_order_relaxed))
+	{
+		ptr = hugePageAllocate(size);
+	}
+	
+	if (ptr == nullptr)
+	{
+		ptr = malloc((size > 0) ? size : 1);
+	}
+	
+	if (ptr == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	
+	size_t usable = malloc_usable_size(ptr);
+	
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	
+	size_t inUse = heapInUse.fetch_add(usable, std::memory_order_relaxed) + usable;
+	size_t peak = peakHeapInUse.load(std::memory_order_relaxed);
+	
+	while (inUse > peak && !peakHeapInUse.compare_exchange_weak(peak, inUse, std::memory_order_relaxed))
+		;
+	
+	return ptr;
+}
+
+
+static void countedFree(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+	
+	heapInUse.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+	
+	free(ptr);
+}
+
+
+void* operator new(size_t size)
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return countedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	countedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	countedFree(ptr);
+}
+
+
+
+/*** Function Definitions ***/
+
+
+void setHugePageBuffers(bool enabled)
+{
+	hugePageBuffers.store(enabled, std::memory_order_relaxed);
+}
+
+
+bool getHugePageBuffers()
+{
+	return hugePageBuffers.load(std::memory_order_relaxed);
+}
+
+
+std::string getTransparentHugePageMode()
+{
+	std::ifstream setting("/sys/kernel/mm/transparent_hugepage/enabled");
+	std::string line;
+	
+	if (!std::getline(setting, line))
+		return "unavailable";
+	
+	/* The active mode is the one in brackets, ex. "always [madvise] never" */
+	
+	size_t open = line.find('[');
+	size_t close = line.find(']', open);
+	
+	if (open == std::string::npos || close == std::string::npos)
+		return line;
+	
+	return line.substr(open + 1, close - open - 1);
+}
+
+size_t getPeakResidentMemory()
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 6, "VmHWM:") == 0)
+		{
+			std::stringstream value(line.substr(6));
+			size_t kilobytes = 0;
+			
+			value >> kilobytes;
+			
+			return kilobytes << 10;
+		}
+	}
+	
+	return 0;
+}
+
+
+// Resets the VmHWM peak of the process to its current resident set size. Returns false if the kernel
+// does not allow it
+//
+static bool resetPeakResidentMemory()
+{
+	std::ofstream clearRefs("/proc/self/clear_refs");
+	
+	if (!clearRefs.is_open())
+		return false;
+	
+	clearRefs << "5";
+	clearRefs.flush();
+	
+	return clearRefs.good();
+}
+
+
+void startMemoryStats(MemoryStats* stats)
+{
+	*stats = MemoryStats();
+	
+	stats->peakResidentIsLocal = resetPeakResidentMemory();
+	
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	
+	stats->startMinorFaults = usage.ru_minflt;
+	stats->startMajorFaults = usage.ru_majflt;
+	
+	stats->startAllocations = allocationCount.load(std::memory_order_relaxed);
+	stats->startBytesAllocated = allocatedBytes.load(std::memory_order_relaxed);
+	stats->startHeapInUse = heapInUse.load(std::memory_order_relaxed);
+	stats->startHugePageAllocations = hugePageAllocationCount.load(std::memory_order_relaxed);
+	
+	peakHeapInUse.store(stats->startHeapInUse, std::memory_order_relaxed);
+}
+
+
+void stopMemoryStats(MemoryStats* stats)
+{
+	stats->allocations = allocationCount.load(std::memory_order_relaxed) - stats->startAllocations;
+	stats->bytesAllocated = allocatedBytes.load(std::memory_order_relaxed) - stats->startBytesAllocated;
+	stats->peakHeapGrowth = peakHeapInUse.load(std::memory_order_relaxed) - stats->startHeapInUse;
+	stats->hugePageAllocations = hugePageAllocationCount.load(std::memory_order_relaxed) - stats->startHugePageAllocations;
+	
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	
+	stats->minorFaults = usage.ru_minflt - stats->startMinorFaults;
+	stats->majorFaults = usage.ru_majflt - stats->startMajorFaults;
+	
+	stats->peakResident = getPeakResidentMemory();
+	
+	/* Without /proc, fall back to the lifetime peak from getrusage (in kilobytes on Linux) */
+	
+	if (stats->peakResident == 0)
+	{
+		stats->peakResident = (size_t)usage.ru_maxrss << 10;
+		stats->peakResidentIsLocal = false;
+	}
+}
+
+
+std::string formatMemorySize(size_t bytes)
+{
+	const char* units[] = { "bytes", "KB", "MB", "GB", "TB" };
+	
+	double size = bytes;
+	int unit = 0;
+	
+	while (size >= 1024 && unit < 4)
+	{
+		size /= 1024;
+		unit++;
+	}
+	
+	std::stringstream formatted;
+	
+	if (unit == 0)
+		formatted << bytes << " " << units[unit];
+	else
+		formatted << std::fixed << std::setprecision(2) << size << " " << units[unit];
+	
+	return formatted.str();
+}
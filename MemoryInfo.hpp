@@ -0,0 +1,78 @@
+/**
+*  MemoryInfo.hpp
+*
+*  Declares the process memory measurements and allocation counting shown in the reports
+*/
+
+#ifndef MEMORY_INFO_HPP_MULTITHREADED_SORTING
+#define MEMORY_INFO_HPP_MULTITHREADED_SORTING
+
+
+#include <cstddef>
+#include <string>
+
+
+/*** Data Structures ***/
+
+// Memory use of a measured section (such as the timed sort), filled in by startMemoryStats() and
+// stopMemoryStats(). Allocations are counted by the global operator new/delete in MemoryInfo.cpp
+//
+struct MemoryStats
+{
+	size_t allocations{};		// Calls to operator new
+	size_t bytesAllocated{};	// Bytes requested from operator new
+	size_t peakHeapGrowth{};	// Largest amount of heap memory in use above the amount at the start
+	size_t hugePageAllocations{};	// Large buffers placed on 2 MB boundaries and advised to use huge pages
+	
+	size_t peakResident{};		// Peak resident set size in bytes
+	bool peakResidentIsLocal{};	// True if the peak was reset at the start, so it only covers the section
+	
+	size_t minorFaults{};		// Page faults served without I/O (mostly first touches of new memory)
+	size_t majorFaults{};		// Page faults that needed I/O
+	
+	/* Values at the start of the section */
+	
+	size_t startAllocations{};
+	size_t startBytesAllocated{};
+	size_t startHeapInUse{};
+	size_t startHugePageAllocations{};
+	size_t startMinorFaults{};
+	size_t startMajorFaults{};
+};
+
+
+
+/*** Function Declarations ***/
+
+// Turns huge page buffers on (the default) or off. When on, allocations of 4 MB or more (the data, and the
+// scratch buffers of the sorts) are aligned to 2 MB and given to madvise(MADV_HUGEPAGE)
+//
+void setHugePageBuffers(bool enabled);
+
+// Checks if huge page buffers are turned on
+//
+bool getHugePageBuffers();
+
+// Gets the transparent huge page mode of the kernel ("always", "madvise", "never" or "unavailable")
+//
+std::string getTransparentHugePageMode();
+
+// Gets the peak resident set size of the process so far in bytes (VmHWM in /proc/self/status, 0 if unavailable)
+//
+size_t getPeakResidentMemory();
+
+// Starts measuring: saves the current counters, and resets the heap and resident set size peaks
+// (the latter only where the kernel allows it through /proc/self/clear_refs)
+//
+void startMemoryStats(MemoryStats* stats);
+
+// Stops measuring and fills in the counts and peaks since startMemoryStats()
+//
+void stopMemoryStats(MemoryStats* stats);
+
+// Formats a number of bytes for the reports (ex. "7.63 MB")
+//
+std::string formatMemorySize(size_t bytes);
+
+
+#endif
@@ -0,0 +1,220 @@
+/**
+*  parBlockMergeSort.cpp
+*
+*  Defines the parallel cache-blocked bottom-up Merge Sort function
+*/
+
+#include "parSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+
+
+const size_t SPLIT_SAMPLES_PER_RUN = 64;
+
+
+// Reuse the tile sort and multi-way merge from the sequential version
+//
+void sortTile(int32_t* tile, int32_t* scratch, size_t length);
+void multiwayMerge(std::vector<const int32_t*> begins, std::vector<const int32_t*> ends, int32_t* out);
+
+
+// One piece of a merge pass: the values in [low..high) of runs bounds[first..last]. 'lowOpen' and
+// 'highOpen' remove the lower and upper limit, so the first and last pieces take every value
+//
+struct MergeTask
+{
+	size_t first;
+	size_t last;
+	
+	int32_t low;
+	int32_t high;
+	bool lowOpen;
+	bool highOpen;
+};
+
+
+// Sorts the tiles tileSize * [first..last) of 'arr'
+//
+static void sortTiles(int32_t* arr, int32_t* scratch, size_t n, size_t tileSize, size_t first, size_t last)
+{
+	for (size_t tile = first; tile < last; tile++)
+	{
+		size_t begin = tile * tileSize;
+		
+		sortTile(arr + begin, scratch + begin, std::min(tileSize, n - begin));
+	}
+}
+
+
+// Merges the part of runs bounds[task.first..task.last] that task covers into its place in 'dst'
+//
+static void runMergeTask(int32_t* src, int32_t* dst, std::vector<size_t>* bounds, MergeTask task)
+{
+	std::vector<const int32_t*> begins, ends;
+	
+	size_t offset = bounds->at(task.first);
+	
+	for (size_t r = task.first; r < task.last; r++)
+	{
+		const int32_t* runBegin = src + bounds->at(r);
+		const int32_t* runEnd = src + bounds->at(r + 1);
+		
+		const int32_t* begin = (task.lowOpen) ? runBegin : std::lower_bound(runBegin, runEnd, task.low);
+		const int32_t* end = (task.highOpen) ? runEnd : std::lower_bound(runBegin, runEnd, task.high);
+		
+		begins.push_back(begin);
+		ends.push_back(end);
+		
+		offset += begin - runBegin;
+	}
+	
+	multiwayMerge(begins, ends, dst + offset);
+}
+
+
+// Splits the merge of runs bounds[first..last] into 'parts' tasks by value: splitters are taken from
+// evenly spaced samples of every run, and each run is cut at the splitters with a binary search
+//
+static void splitMerge(int32_t* src, std::vector<size_t>* bounds, size_t first, size_t last, size_t parts, std::vector<MergeTask>* tasks)
+{
+	std::vector<int32_t> samples;
+	
+	for (size_t r = first; r < last; r++)
+	{
+		size_t length = bounds->at(r + 1) - bounds->at(r);
+		
+		for (size_t s = 1; s <= SPLIT_SAMPLES_PER_RUN && s <= length; s++)
+		{
+			samples.push_back(src[bounds->at(r) + length * s / (SPLIT_SAMPLES_PER_RUN + 1)]);
+		}
+	}
+	
+	std::sort(samples.begin(), samples.end());
+	
+	std::vector<int32_t> splitters;
+	
+	for (size_t part = 1; part < parts && !samples.empty(); part++)
+	{
+		int32_t splitter = samples[samples.size() * part / parts];
+		
+		if (splitters.empty() || splitter > splitters.back())
+			splitters.push_back(splitter);
+	}
+	
+	for (size_t s = 0; s <= splitters.size(); s++)
+	{
+		MergeTask task;
+		
+		task.first = first;
+		task.last = last;
+		task.lowOpen = (s == 0);
+		task.highOpen = (s == splitters.size());
+		task.low = (task.lowOpen) ? 0 : splitters[s - 1];
+		task.high = (task.highOpen) ? 0 : splitters[s];
+		
+		tasks->push_back(task);
+	}
+}
+
+
+void parBlockMergeSort(int32_t* arr, size_t n, size_t tileSize, size_t mergeWays, int32_t numThreads)
+{
+	if (n < 2)
+	{
+		return;
+	}
+	
+	tileSize = std::max<size_t>(tileSize, 1);
+	mergeWays = std::max<size_t>(mergeWays, 2);
+	
+	std::vector<int32_t> scratch(n);
+	std::vector<std::thread> threads;
+	
+	
+	/* Every thread sorts a contiguous group of tiles, one tile at a time so it stays in that core's L2 */
+	
+	size_t numTiles = (n + tileSize - 1) / tileSize;
+	size_t tilesPerThread = (numTiles + numThreads - 1) / numThreads;
+	
+	for (size_t first = 0; first < numTiles; first += tilesPerThread)
+	{
+		threads.push_back(std::thread(sortTiles, arr, scratch.data(), n, tileSize, first, std::min(first + tilesPerThread, numTiles)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	std::vector<size_t> bounds;
+	
+	for (size_t tile = 0; tile < numTiles; tile++)
+	{
+		bounds.push_back(tile * tileSize);
+	}
+	
+	bounds.push_back(n);
+	
+	
+	/* Multi-way merge passes. When there are fewer groups than threads (the last passes), each group is
+	   split by value so every thread still has a part to merge */
+	
+	int32_t* src = arr;
+	int32_t* dst = scratch.data();
+	
+	while (bounds.size() > 2)
+	{
+		std::vector<size_t> merged;
+		std::vector<MergeTask> tasks;
+		
+		size_t numGroups = (bounds.size() - 1 + mergeWays - 1) / mergeWays;
+		size_t partsPerGroup = std::max<size_t>(1, numThreads / numGroups);
+		
+		for (size_t first = 0; first + 1 < bounds.size(); first += mergeWays)
+		{
+			size_t last = std::min(first + mergeWays, bounds.size() - 1);
+			
+			splitMerge(src, &bounds, first, last, partsPerGroup, &tasks);
+			
+			merged.push_back(bounds[first]);
+		}
+		
+		merged.push_back(n);
+		
+		for (size_t t = 0; t < tasks.size(); t += numThreads)
+		{
+			threads.clear();
+			
+			for (size_t task = t; task < std::min(t + numThreads, tasks.size()); task++)
+			{
+				threads.push_back(std::thread(runMergeTask, src, dst, &bounds, tasks[task]));
+			}
+			
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+		}
+		
+		bounds = merged;
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != arr)
+	{
+		std::copy(src, src + n, arr);
+	}
+}
+
+
+void parBlockMergeSort(std::vector<int32_t>* arr, size_t tileSize, size_t mergeWays, int32_t numThreads)
+{
+	if (arr == nullptr)
+	{
+		return;
+	}
+	
+	parBlockMergeSort(arr->data(), arr->size(), tileSize, mergeWays, numThreads);
+}
@@ -0,0 +1,153 @@
+/**
+*  parCountingSort.cpp
+*
+*  Defines the parallel Counting Sort function, used for keys that span a small range
+*/
+
+#include "parSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+
+
+// Finds the smallest and largest values of arr[left..right)
+//
+static void blockMinMax(std::vector<int32_t>* arr, size_t left, size_t right, int32_t* min, int32_t* max)
+{
+	*min = INT32_MAX;
+	*max = INT32_MIN;
+	
+	for (size_t i = left; i < right; i++)
+	{
+		*min = std::min(*min, arr->at(i));
+		*max = std::max(*max, arr->at(i));
+	}
+}
+
+
+// Counts the keys of arr[left..right) into 'counts', which is indexed by key - 'min'
+//
+static void countBlock(std::vector<int32_t>* arr, size_t left, size_t right, int32_t min, size_t* counts)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		counts[(int64_t)arr->at(i) - min]++;
+	}
+}
+
+
+// Adds up the per-thread counts of keys [first..last) and writes those keys to their place in 'arr'.
+// 'offset' is where the first of these keys goes in the sorted output
+//
+static void fillKeys(std::vector<int32_t>* arr, std::vector<std::vector<size_t>>* counts, size_t first, size_t last, int32_t min, size_t offset)
+{
+	for (size_t key = first; key < last; key++)
+	{
+		size_t total = 0;
+		
+		for (std::vector<size_t>& threadCounts : *counts)
+		{
+			total += threadCounts[key];
+		}
+		
+		std::fill(arr->begin() + offset, arr->begin() + offset + total, (int32_t)(min + (int64_t)key));
+		
+		offset += total;
+	}
+}
+
+
+void parMinMax(std::vector<int32_t>* arr, int32_t numThreads, int32_t* min, int32_t* max)
+{
+	size_t blockSize = (arr->size() + numThreads - 1) / numThreads;
+	
+	std::vector<int32_t> mins(numThreads), maxs(numThreads);
+	std::vector<std::thread> threads;
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(t * blockSize, arr->size());
+		size_t right = std::min(left + blockSize, arr->size());
+		
+		threads.push_back(std::thread(blockMinMax, arr, left, right, &mins[t], &maxs[t]));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	*min = *std::min_element(mins.begin(), mins.end());
+	*max = *std::max_element(maxs.begin(), maxs.end());
+}
+
+
+void parCountingSort(std::vector<int32_t>* arr, int32_t min, int32_t max, int32_t numThreads)
+{
+	if (arr == nullptr || arr->empty())
+	{
+		return;
+	}
+	
+	size_t range = (size_t)((int64_t)max - min) + 1;
+	size_t blockSize = (arr->size() + numThreads - 1) / numThreads;
+	
+	
+	/* Pass 1: every thread counts the keys of its block */
+	
+	std::vector<std::vector<size_t>> counts(numThreads, std::vector<size_t>(range));
+	std::vector<std::thread> threads;
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(t * blockSize, arr->size());
+		size_t right = std::min(left + blockSize, arr->size());
+		
+		threads.push_back(std::thread(countBlock, arr, left, right, min, counts[t].data()));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	
+	/* Where each thread's slice of keys starts in the output (one cheap pass over the key range) */
+	
+	size_t keysPerThread = (range + numThreads - 1) / numThreads;
+	
+	std::vector<size_t> offsets(numThreads + 1);
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t total = 0;
+		
+		for (size_t key = std::min(t * keysPerThread, range); key < std::min((t + 1) * keysPerThread, range); key++)
+		{
+			for (std::vector<size_t>& threadCounts : counts)
+			{
+				total += threadCounts[key];
+			}
+		}
+		
+		offsets[t + 1] = offsets[t] + total;
+	}
+	
+	
+	/* Pass 2: every thread writes its slice of keys, in order, to its part of the output */
+	
+	threads.clear();
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t first = std::min(t * keysPerThread, range);
+		size_t last = std::min(first + keysPerThread, range);
+		
+		threads.push_back(std::thread(fillKeys, arr, &counts, first, last, min, offsets[t]));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+}
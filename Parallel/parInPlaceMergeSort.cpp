@@ -0,0 +1,88 @@
+/**
+*  parInPlaceMergeSort.cpp
+*
+*  Defines the parallel in-place (low memory) Merge Sort function
+*/
+
+#include "parSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+
+
+const size_t PARALLEL_MERGE_CUTOFF = 1 << 16;
+
+
+// Reuse the in-place merge and sort from the sequential version
+//
+void symMerge(int32_t* arr, size_t a, size_t m, size_t b);
+void symMergeRotate(int32_t* arr, size_t a, size_t m, size_t b, size_t* start, size_t* mid, size_t* end);
+void inPlaceMergeSort(int32_t* arr, size_t begin, size_t end);
+
+
+// Same as symMerge(), but while the range is large and there are threads to spare, the left of the two
+// independent merges left after the rotation is given to a new thread
+//
+static void parSymMerge(int32_t* arr, size_t a, size_t m, size_t b, int32_t numThreads)
+{
+	if (numThreads <= 1 || b - a <= PARALLEL_MERGE_CUTOFF || m - a <= 1 || b - m <= 1)
+	{
+		symMerge(arr, a, m, b);
+		return;
+	}
+	
+	size_t start, mid, end;
+	
+	symMergeRotate(arr, a, m, b, &start, &mid, &end);
+	
+	std::thread left(parSymMerge, arr, a, start, mid, numThreads / 2);
+	
+	parSymMerge(arr, mid, end, b, numThreads - numThreads / 2);
+	
+	left.join();
+}
+
+
+// Sorts arr[begin..end) in place with 'numThreads' threads: the halves are sorted by separate groups of
+// threads, then merged in place (in parallel as well)
+//
+static void parInPlaceSortRange(int32_t* arr, size_t begin, size_t end, int32_t numThreads)
+{
+	if (numThreads <= 1 || end - begin <= PARALLEL_MERGE_CUTOFF)
+	{
+		inPlaceMergeSort(arr, begin, end);
+		return;
+	}
+	
+	size_t mid = begin + (end - begin) / 2;
+	
+	std::thread left(parInPlaceSortRange, arr, begin, mid, numThreads / 2);
+	
+	parInPlaceSortRange(arr, mid, end, numThreads - numThreads / 2);
+	
+	left.join();
+	
+	parSymMerge(arr, begin, mid, end, numThreads);
+}
+
+
+void parInPlaceMergeSort(int32_t* arr, size_t n, int32_t numThreads)
+{
+	if (n < 2)
+	{
+		return;
+	}
+	
+	parInPlaceSortRange(arr, 0, n, numThreads);
+}
+
+
+void parInPlaceMergeSort(std::vector<int32_t>* arr, int32_t numThreads)
+{
+	if (arr == nullptr)
+	{
+		return;
+	}
+	
+	parInPlaceMergeSort(arr->data(), arr->size(), numThreads);
+}
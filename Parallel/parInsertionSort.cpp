@@ -11,18 +11,18 @@
 
 // Reuse the merge function from merge sort
 //
-void merge(std::vector<int32_t> *arr, int32_t l, int32_t m, int32_t r);
+void merge(std::vector<int32_t> *arr, int64_t l, int64_t m, int64_t r);
 
 
 // Sorts the values in 'arr' between the indices 'left' and 'right'
 //
-void insertionSort(std::vector<int32_t>* arr, int32_t left, int32_t right)
+void insertionSort(std::vector<int32_t>* arr, int64_t left, int64_t right)
 {
-	for (int32_t i = left + 1; i <= right; i++)
+	for (int64_t i = left + 1; i <= right; i++)
 	{
 		int32_t curr = arr->at(i);
 		
-		int32_t j;
+		int64_t j;
 		
 		for (j = i; j > left && arr->at(j - 1) > curr; j--)
 		{
@@ -37,13 +37,13 @@ void insertionSort(std::vector<int32_t>* arr, int32_t left, int32_t right)
 // Splits 'arr' recursively to be sorted by multiple threads using insertionSort(). After each
 // sub-array is sorted, they are merged together.
 //
-void splitWork(std::vector<int32_t>* arr, int32_t left, int32_t right, int32_t threadsRemaining)
+void splitWork(std::vector<int32_t>* arr, int64_t left, int64_t right, int32_t threadsRemaining)
 {
 	if (threadsRemaining)
 	{
 		threadsRemaining--;
 		
-		int32_t center = left + (right - left) / 2;
+		int64_t center = left + (right - left) / 2;
 		
 		std::thread twin = std::thread(splitWork, arr, center, right, threadsRemaining / 2);
 		
@@ -64,7 +64,7 @@ void splitWork(std::vector<int32_t>* arr, int32_t left, int32_t right, int32_t t
 //
 void parInsertionSort(std::vector<int32_t>* arr, int32_t numThreads)
 {
-	std::thread firstThread = std::thread(splitWork, arr, 0, arr->size() - 1, numThreads - 1);
+	std::thread firstThread = std::thread(splitWork, arr, 0, (int64_t)arr->size() - 1, numThreads - 1);
 	
 	firstThread.join();
 }
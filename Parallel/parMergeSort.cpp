@@ -5,96 +5,51 @@
  */
 
 #include "parSorts.hpp"
+#include "../CpuDispatch.hpp"
 #include <math.h>
+#include <algorithm>
 #include <stdexcept>
 #include <thread>
 
+// Reuse the sort from the sequential merge sort
+//
+void mergeSort(int32_t* src, int32_t* dst, size_t n);
+
 /**
- * @brief  Merges two subarrays of arr[]
+ * @brief  Merges two subarrays of arr[] (used by the parallel insertion sort)
  * @param  arr: The array to be sorted
  * @param  l: The left index of the first subarray
  * @param  m: The right index of the first subarray
  * @param  r: The right index of the second subarray
  */
-void merge(std::vector<int32_t> *arr, int32_t l, int32_t m, int32_t r)
+void merge(std::vector<int32_t> *arr, int64_t l, int64_t m, int64_t r)
 {
-    int32_t i, j, k;
-    int32_t n1 = m - l + 1;
-    int32_t n2 = r - m;
-
-    // create temp arrays
-    std::vector<int32_t> L(n1), R(n2);
+    // Copy both subarrays to one temp array, then merge them back into arr[l..r] with the kernel for this CPU
+    std::vector<int32_t> temp(arr->begin() + l, arr->begin() + r + 1);
 
-    // Copy data to temp arrays L[] and R[]
-    for (i = 0; i < n1; i++)
-        L[i] = arr->at(l + i);
-    for (j = 0; j < n2; j++)
-        R[j] = arr->at(m + 1 + j);
-
-    // Merge the temp arrays back into arr[l..r]
-    i = 0; // Initial index of first subarray
-    j = 0; // Initial index of second subarray
-    k = l; // Initial index of merged subarray
-    while (i < n1 && j < n2)
-    {
-        if (L[i] <= R[j])
-        {
-            arr->at(k) = L[i];
-            i++;
-        }
-        else
-        {
-            arr->at(k) = R[j];
-            j++;
-        }
-        k++;
-    }
-
-    // Copy the remaining elements of L[], if there are any
-    while (i < n1)
-    {
-        arr->at(k) = L[i];
-        i++;
-        k++;
-    }
-
-    // Copy the remaining elements of R[], if there are any
-    while (j < n2)
-    {
-        arr->at(k) = R[j];
-        j++;
-        k++;
-    }
+    mergeKernel(temp.data(), m - l + 1, temp.data() + (m - l + 1), r - m, arr->data() + l);
 }
 
 /**
- * @brief  Sorts an array using merge sort algorithm
- * @param  arr: The array to be sorted
- * @param  begin: The left index of the array
- * @param  end: The right index of the array
+ * @brief  Sorts one block of the array, run by each thread
+ * @param  block: The values to be sorted
+ * @param  scratch: Scratch space of the same length
+ * @param  length: The number of values in the block
  */
-void mergeSort(std::vector<int32_t> *arr, int32_t begin, int32_t end)
+static void sortBlock(int32_t *block, int32_t *scratch, int64_t length)
 {
-    // Base case
-    if (begin >= end)
-        return;
-
-    // Sort the left and right halves of the array
-    int32_t middle = begin + (end - begin) / 2;
-    mergeSort(arr, begin, middle);
-    mergeSort(arr, middle + 1, end);
-    
-    // Merge the sorted halves
-    merge(arr, begin, middle, end);
+    std::copy(block, block + length, scratch);
+    mergeSort(scratch, block, length);
 }
 
 /**
  * @author John Boyd
  * @brief  Sorts an array using a parallelize version of the merge sort algorithm
  * @param  arr: The array to be sorted
+ * @param  size: The number of values in the array
  * @param  numThreads: The number of threads to use
  */
-void parMergeSort(std::vector<int32_t> *arr, int32_t numThreads)
+void parMergeSort(int32_t *arr, int64_t size, int32_t numThreads)
 {
     // Ensure that the number of threads is valid
     if (numThreads < 1)
@@ -102,13 +57,19 @@ void parMergeSort(std::vector<int32_t> *arr, int32_t numThreads)
         throw std::invalid_argument("Number of threads must be at least 1");
     }
 
-    // Sort blocks of the array in parallel
-    int32_t blockSize = ceil(arr->size() / numThreads);
-    std::vector<std::thread> threads(numThreads);
-    for (int32_t i = 0; i < numThreads; i++)
+    // One scratch buffer for the whole sort, which the merges go back and forth through
+    std::vector<int32_t> scratch(size);
+    int32_t *data = arr;
+    int32_t *buffer = scratch.data();
+
+    // Sort blocks of the array in parallel (rounding up so the last block reaches the end)
+    int64_t blockSize = std::max<int64_t>(1, (size + numThreads - 1) / numThreads);
+    std::vector<std::thread> threads;
+    for (int64_t i = 0; i < numThreads && i * blockSize < size; i++)
     {
-        int32_t end = std::min((i + 1) * blockSize - 1, (int32_t)arr->size() - 1); // Bounds check
-        threads[i] = std::thread(mergeSort, arr, i * blockSize, end);
+        int64_t begin = i * blockSize;
+        int64_t length = std::min(blockSize, size - begin); // Bounds check
+        threads.push_back(std::thread(sortBlock, data + begin, buffer + begin, length));
     }
 
     // Wait for all threads to finish
@@ -117,16 +78,36 @@ void parMergeSort(std::vector<int32_t> *arr, int32_t numThreads)
         t.join();
     }
 
-    // Merge sorted blocks back together
-    for (int32_t size = blockSize; size < arr->size(); size = 2 * size)
+    // Merge sorted blocks back together, each pass reading one buffer and writing the other
+    int32_t *src = data;
+    int32_t *dst = buffer;
+    for (int64_t width = blockSize; width < size; width = 2 * width)
     {
-        // Pick starting point of different subarrays of current size
-        for (int32_t left_start = 0; left_start < arr->size(); left_start += 2 * size)
+        // Pick starting point of different subarrays of current width (the last block may have no
+        // partner, and is then just copied)
+        for (int64_t left_start = 0; left_start < size; left_start += 2 * width)
         {
-            int32_t mid = left_start + size - 1;
-            int32_t right_end = std::min(left_start + 2 * size - 1, (int32_t)(arr->size() - 1));
+            int64_t mid = std::min(left_start + width, size);
+            int64_t right_end = std::min(left_start + 2 * width, size);
 
-            merge(arr, left_start, mid, right_end);
+            mergeKernel(src + left_start, mid - left_start, src + mid, right_end - mid, dst + left_start);
         }
+
+        std::swap(src, dst);
+    }
+
+    if (src != data)
+    {
+        std::copy(src, src + size, data);
     }
 }
+
+/**
+ * @brief  Sorts a vector using the parallel merge sort
+ * @param  arr: The vector to be sorted
+ * @param  numThreads: The number of threads to use
+ */
+void parMergeSort(std::vector<int32_t> *arr, int32_t numThreads)
+{
+    parMergeSort(arr->data(), arr->size(), numThreads);
+}
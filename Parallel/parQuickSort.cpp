@@ -6,8 +6,72 @@
 
 #include "parSorts.hpp"
 
+#include <thread>
+#include <algorithm>
+
+
+const size_t PARALLEL_SORT_CUTOFF = 1 << 16;
+
+
+// Reuse the sequential quick sort and the parallel three-way partition from selection
+//
+void quickSort(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void parPartition(std::vector<int32_t>* arr, std::vector<int32_t>* buffer, size_t low, size_t high, int32_t pivot, int32_t numThreads, size_t* less, size_t* equal);
+
+
+// Sorts arr[low..high) with 'numThreads' threads: the range is split three ways around a pivot by all
+// of them, then the threads are divided between the less and greater parts by size. Keys equal to the
+// pivot are already in place, so duplicate-heavy data shrinks quickly
+//
+static void quickSortRange(std::vector<int32_t>* arr, std::vector<int32_t>* buffer, size_t low, size_t high, int32_t numThreads)
+{
+	if (numThreads <= 1 || high - low <= PARALLEL_SORT_CUTOFF)
+	{
+		if (high - low > 1)
+		{
+			quickSort(*arr, low, high - 1);
+		}
+		
+		return;
+	}
+	
+	int32_t a = arr->at(low);
+	int32_t b = arr->at(low + (high - low) / 2);
+	int32_t c = arr->at(high - 1);
+	
+	int32_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+	
+	size_t less, equal;
+	
+	parPartition(arr, buffer, low, high, pivot, numThreads, &less, &equal);
+	
+	size_t greater = (high - low) - less - equal;
+	
+	if (less + greater == 0)
+	{
+		return;
+	}
+	
+	int32_t leftThreads = (int32_t)((numThreads * less + (less + greater) / 2) / (less + greater));
+	
+	leftThreads = std::max(1, std::min(numThreads - 1, leftThreads));
+	
+	std::thread left(quickSortRange, arr, buffer, low, low + less, leftThreads);
+	
+	quickSortRange(arr, buffer, high - greater, high, numThreads - leftThreads);
+	
+	left.join();
+}
+
 
 void parQuickSort(std::vector<int32_t>* arr, int32_t numThreads)
 {
+	if (arr == nullptr || arr->empty())
+	{
+		return;
+	}
+	
+	std::vector<int32_t> buffer(arr->size());
 	
+	quickSortRange(arr, &buffer, 0, arr->size(), numThreads);
 }
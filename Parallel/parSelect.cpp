@@ -0,0 +1,220 @@
+/**
+*  parSelect.cpp
+*
+*  Defines the parallel top-k and nth element selection functions
+*/
+
+#include "parSorts.hpp"
+#include "../CpuDispatch.hpp"
+
+#include <thread>
+#include <algorithm>
+
+
+const size_t HEAP_SELECT_MAX_K = 1024;
+const size_t PARALLEL_SELECT_CUTOFF = 1 << 16;
+
+
+// Reuse the sequential selection functions
+//
+void quickSelect(std::vector<int32_t>& arr, int64_t low, int64_t high, int64_t target);
+void heapSelect(const int32_t* begin, const int32_t* end, size_t k, std::vector<int32_t>* heap);
+
+
+// Counts the values of arr[left..right) that are less than, equal to and greater than 'pivot'
+//
+static void countAroundPivot(std::vector<int32_t>* arr, size_t left, size_t right, int32_t pivot, size_t* counts)
+{
+	countAroundPivotKernel(arr->data() + left, right - left, pivot, counts);
+}
+
+
+// Copies arr[left..right) into 'buffer' at the less/equal/greater positions given by 'offsets'
+//
+static void scatterAroundPivot(std::vector<int32_t>* arr, std::vector<int32_t>* buffer, size_t left, size_t right, int32_t pivot, size_t* offsets)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		int32_t value = arr->at(i);
+		
+		buffer->at(offsets[(value < pivot) ? 0 : ((value == pivot) ? 1 : 2)]++) = value;
+	}
+}
+
+
+// Partitions arr[low..high) into less than, equal to and greater than 'pivot' using every thread,
+// and returns the sizes of the first two parts ('buffer' must be at least as large as 'arr')
+//
+void parPartition(std::vector<int32_t>* arr, std::vector<int32_t>* buffer, size_t low, size_t high, int32_t pivot, int32_t numThreads, size_t* less, size_t* equal)
+{
+	size_t blockSize = (high - low + numThreads - 1) / numThreads;
+	
+	std::vector<size_t> counts(3 * numThreads);
+	std::vector<std::thread> threads;
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(low + t * blockSize, high);
+		size_t right = std::min(left + blockSize, high);
+		
+		threads.push_back(std::thread(countAroundPivot, arr, left, right, pivot, &counts[3 * t]));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	/* Each thread writes its part of every section after the threads before it */
+	
+	*less = *equal = 0;
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		*less += counts[3 * t];
+		*equal += counts[3 * t + 1];
+	}
+	
+	size_t offsets[3] = { low, low + *less, low + *less + *equal };
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		for (int part = 0; part < 3; part++)
+		{
+			size_t count = counts[3 * t + part];
+			
+			counts[3 * t + part] = offsets[part];
+			
+			offsets[part] += count;
+		}
+	}
+	
+	threads.clear();
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(low + t * blockSize, high);
+		size_t right = std::min(left + blockSize, high);
+		
+		threads.push_back(std::thread(scatterAroundPivot, arr, buffer, left, right, pivot, &counts[3 * t]));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	std::copy(buffer->begin() + low, buffer->begin() + high, arr->begin() + low);
+}
+
+
+int32_t parNthElement(std::vector<int32_t>* arr, size_t n, int32_t numThreads)
+{
+	size_t low = 0;
+	size_t high = arr->size();
+	
+	std::vector<int32_t> buffer;
+	
+	/* Parallel quickselect while the range is large, keeping only the part that holds index n */
+	
+	while (high - low > PARALLEL_SELECT_CUTOFF && numThreads > 1)
+	{
+		if (buffer.empty())
+		{
+			buffer.resize(arr->size());
+		}
+		
+		int32_t a = arr->at(low);
+		int32_t b = arr->at(low + (high - low) / 2);
+		int32_t c = arr->at(high - 1);
+		
+		int32_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+		
+		size_t less, equal;
+		
+		parPartition(arr, &buffer, low, high, pivot, numThreads, &less, &equal);
+		
+		if (n < low + less)
+		{
+			high = low + less;
+		}
+		else if (n < low + less + equal)
+		{
+			return pivot;
+		}
+		else
+		{
+			low = low + less + equal;
+		}
+	}
+	
+	quickSelect(*arr, low, high - 1, n);
+	
+	return arr->at(n);
+}
+
+
+// Keeps the k smallest values of arr[left..right) in 'heap'
+//
+static void blockHeapSelect(std::vector<int32_t>* arr, size_t left, size_t right, size_t k, std::vector<int32_t>* heap)
+{
+	heapSelect(arr->data() + left, arr->data() + right, k, heap);
+}
+
+
+void parTopK(std::vector<int32_t>* arr, size_t k, int32_t numThreads)
+{
+	if (arr == nullptr)
+		return;
+	
+	k = std::min(k, arr->size());
+	
+	if (k <= HEAP_SELECT_MAX_K)
+	{
+		/* Small k: every thread keeps a heap of the k smallest values of its block, then the
+		   at most numThreads * k survivors are reduced to the final k */
+		
+		size_t blockSize = (arr->size() + numThreads - 1) / numThreads;
+		
+		std::vector<std::vector<int32_t>> heaps(numThreads);
+		std::vector<std::thread> threads;
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			size_t left = std::min(t * blockSize, arr->size());
+			size_t right = std::min(left + blockSize, arr->size());
+			
+			threads.push_back(std::thread(blockHeapSelect, arr, left, right, k, &heaps[t]));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::vector<int32_t> candidates;
+		
+		for (std::vector<int32_t>& heap : heaps)
+		{
+			candidates.insert(candidates.end(), heap.begin(), heap.end());
+		}
+		
+		std::vector<int32_t> heap;
+		
+		heapSelect(candidates.data(), candidates.data() + candidates.size(), k, &heap);
+		
+		std::sort_heap(heap.begin(), heap.end());
+		
+		arr->swap(heap);
+	}
+	else
+	{
+		/* Large k: move the k smallest to the front, then sort only those */
+		
+		parNthElement(arr, k - 1, numThreads);
+		
+		arr->resize(k);
+		
+		parMergeSort(arr, numThreads);
+	}
+}
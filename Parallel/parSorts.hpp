@@ -10,11 +10,39 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 void parBubbleSort(std::vector<int32_t>*, int32_t numThreads);
 void parInsertionSort(std::vector<int32_t>*, int32_t numThreads);
 void parMergeSort(std::vector<int32_t>*, int32_t numThreads);
 void parQuickSort(std::vector<int32_t>*, int32_t numThreads);
 
+// In-place merge sort (SymMerge with rotations): no scratch buffers, O(n log^2 n) work
+//
+void parInPlaceMergeSort(std::vector<int32_t>*, int32_t numThreads);
+
+// Cache-blocked bottom-up merge sort: sorts tiles of 'tileSize' values, then merges 'mergeWays' runs at a time
+//
+void parBlockMergeSort(std::vector<int32_t>*, size_t tileSize, size_t mergeWays, int32_t numThreads);
+
+// The merge sorts on raw memory, for values that are not in a vector (ex. the shared memory of a service
+// request)
+//
+void parMergeSort(int32_t*, int64_t n, int32_t numThreads);
+void parInPlaceMergeSort(int32_t*, size_t n, int32_t numThreads);
+void parBlockMergeSort(int32_t*, size_t n, size_t tileSize, size_t mergeWays, int32_t numThreads);
+
+// Counting sort for keys known to lie in [min..max], worthwhile when that range is small next to the size.
+// parMinMax() is the pre-scan that finds the range
+//
+void parCountingSort(std::vector<int32_t>*, int32_t min, int32_t max, int32_t numThreads);
+void parMinMax(std::vector<int32_t>*, int32_t numThreads, int32_t* min, int32_t* max);
+
+// Selection: after parTopK() the vector holds only its k smallest values, sorted. parNthElement()
+// returns the value at index n of the sorted order and leaves smaller values before it
+//
+void parTopK(std::vector<int32_t>*, size_t k, int32_t numThreads);
+int32_t parNthElement(std::vector<int32_t>*, size_t n, int32_t numThreads);
+
 
 #endif
@@ -0,0 +1,307 @@
+/**
+*  aosRecordSort.cpp
+*
+*  Defines the stable merge and radix sorts for array of structs records
+*/
+
+#include "recordSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+#include <cstring>
+
+
+const size_t SMALL_RUN = 16;
+const int RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+
+// Reads the key at the start of a record
+//
+static inline int32_t recordKey(const uint8_t* record)
+{
+	int32_t key;
+	
+	std::memcpy(&key, record, sizeof(key));
+	
+	return key;
+}
+
+
+// Sorts the records [left..right) of 'base' with insertion sort, using 'hold' to store one record
+//
+static void insertionSortRecords(uint8_t* base, size_t recordSize, size_t left, size_t right, uint8_t* hold)
+{
+	for (size_t i = left + 1; i < right; i++)
+	{
+		int32_t curr = recordKey(base + i * recordSize);
+		
+		size_t j = i;
+		
+		while (j > left && recordKey(base + (j - 1) * recordSize) > curr)
+		{
+			j--;
+		}
+		
+		if (j != i)
+		{
+			std::memcpy(hold, base + i * recordSize, recordSize);
+			std::memmove(base + (j + 1) * recordSize, base + j * recordSize, (i - j) * recordSize);
+			std::memcpy(base + j * recordSize, hold, recordSize);
+		}
+	}
+}
+
+
+// Merges the records src[left..mid) and src[mid..right) into dst[left..right), taking from the left run on ties
+//
+static void mergeRecords(uint8_t* src, uint8_t* dst, size_t recordSize, size_t left, size_t mid, size_t right)
+{
+	size_t i = left;
+	size_t j = mid;
+	size_t k = left;
+	
+	while (i < mid && j < right)
+	{
+		if (recordKey(src + i * recordSize) <= recordKey(src + j * recordSize))
+			std::memcpy(dst + (k++) * recordSize, src + (i++) * recordSize, recordSize);
+		else
+			std::memcpy(dst + (k++) * recordSize, src + (j++) * recordSize, recordSize);
+	}
+	
+	std::memcpy(dst + k * recordSize, src + i * recordSize, (mid - i) * recordSize);
+	k += mid - i;
+	
+	std::memcpy(dst + k * recordSize, src + j * recordSize, (right - j) * recordSize);
+}
+
+
+// Bottom-up merge sort of the records [left..right), using the same range of 'scratch' as the second buffer
+//
+static void mergeSortRecords(uint8_t* base, uint8_t* scratch, size_t recordSize, size_t left, size_t right)
+{
+	std::vector<uint8_t> hold(recordSize);
+	
+	for (size_t run = left; run < right; run += SMALL_RUN)
+	{
+		insertionSortRecords(base, recordSize, run, std::min(run + SMALL_RUN, right), hold.data());
+	}
+	
+	uint8_t* src = base;
+	uint8_t* dst = scratch;
+	
+	for (size_t width = SMALL_RUN; width < right - left; width *= 2)
+	{
+		for (size_t l = left; l < right; l += 2 * width)
+		{
+			size_t m = std::min(l + width, right);
+			size_t r = std::min(l + 2 * width, right);
+			
+			mergeRecords(src, dst, recordSize, l, m, r);
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != base)
+	{
+		std::memcpy(base + left * recordSize, src + left * recordSize, (right - left) * recordSize);
+	}
+}
+
+
+// Sorts each thread's block, then merges neighbouring blocks in parallel until one run is left
+//
+static void parMergeSortRecords(RecordArray* records, int32_t numThreads)
+{
+	size_t n = records->size();
+	size_t recordSize = records->recordSize;
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<uint8_t> scratch(records->bytes.size());
+	
+	uint8_t* src = records->bytes.data();
+	uint8_t* dst = scratch.data();
+	
+	std::vector<std::thread> threads;
+	
+	for (size_t left = 0; left < n; left += blockSize)
+	{
+		threads.push_back(std::thread(mergeSortRecords, src, dst, recordSize, left, std::min(left + blockSize, n)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	for (size_t width = blockSize; width < n; width *= 2)
+	{
+		threads.clear();
+		
+		for (size_t l = 0; l < n; l += 2 * width)
+		{
+			size_t m = std::min(l + width, n);
+			size_t r = std::min(l + 2 * width, n);
+			
+			threads.push_back(std::thread(mergeRecords, src, dst, recordSize, l, m, r));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != records->bytes.data())
+	{
+		std::memcpy(records->bytes.data(), src, records->bytes.size());
+	}
+}
+
+
+// Gets the radix digit of a record key at 'shift' (sign bit flipped so negative keys sort first)
+//
+static inline size_t recordDigit(const uint8_t* record, int shift)
+{
+	return (((uint32_t)recordKey(record) ^ 0x80000000u) >> shift) & (RADIX_BUCKETS - 1);
+}
+
+
+// Counts the radix digits of the records [left..right) at 'shift'
+//
+static void countRecordDigits(uint8_t* src, size_t recordSize, size_t left, size_t right, int shift, size_t* counts)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		counts[recordDigit(src + i * recordSize, shift)]++;
+	}
+}
+
+
+// Moves the records [left..right) to dst using the running bucket positions in 'offsets'
+//
+static void scatterRecordDigits(uint8_t* src, uint8_t* dst, size_t recordSize, size_t left, size_t right, int shift, size_t* offsets)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		uint8_t* record = src + i * recordSize;
+		
+		std::memcpy(dst + (offsets[recordDigit(record, shift)]++) * recordSize, record, recordSize);
+	}
+}
+
+
+// LSD radix sort of whole records by key. Each pass is stable, so the sort is too
+//
+static void radixSortRecords(RecordArray* records, int32_t numThreads)
+{
+	size_t n = records->size();
+	size_t recordSize = records->recordSize;
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<uint8_t> scratch(records->bytes.size());
+	
+	uint8_t* src = records->bytes.data();
+	uint8_t* dst = scratch.data();
+	
+	std::vector<std::vector<size_t>> counts(numThreads, std::vector<size_t>(RADIX_BUCKETS));
+	
+	for (int shift = 0; shift < 32; shift += RADIX_BITS)
+	{
+		std::vector<std::thread> threads;
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			std::fill(counts[t].begin(), counts[t].end(), 0);
+			
+			size_t left = std::min(t * blockSize, n);
+			size_t right = std::min(left + blockSize, n);
+			
+			if (numThreads == 1)
+				countRecordDigits(src, recordSize, left, right, shift, counts[t].data());
+			else
+				threads.push_back(std::thread(countRecordDigits, src, recordSize, left, right, shift, counts[t].data()));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		/* Starting positions by digit, then by thread, so earlier blocks stay in front of later ones */
+		
+		size_t position = 0;
+		
+		for (size_t digit = 0; digit < RADIX_BUCKETS; digit++)
+		{
+			for (int32_t t = 0; t < numThreads; t++)
+			{
+				size_t count = counts[t][digit];
+				
+				counts[t][digit] = position;
+				
+				position += count;
+			}
+		}
+		
+		threads.clear();
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			size_t left = std::min(t * blockSize, n);
+			size_t right = std::min(left + blockSize, n);
+			
+			if (numThreads == 1)
+				scatterRecordDigits(src, dst, recordSize, left, right, shift, counts[t].data());
+			else
+				threads.push_back(std::thread(scatterRecordDigits, src, dst, recordSize, left, right, shift, counts[t].data()));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != records->bytes.data())
+	{
+		std::memcpy(records->bytes.data(), src, records->bytes.size());
+	}
+}
+
+
+void seqSortRecordArray(RecordArray* records, RecordEngine engine)
+{
+	if (records == nullptr || records->size() < 2)
+		return;
+	
+	if (engine == RecordEngine::Radix)
+	{
+		radixSortRecords(records, 1);
+	}
+	else
+	{
+		std::vector<uint8_t> scratch(records->bytes.size());
+		
+		mergeSortRecords(records->bytes.data(), scratch.data(), records->recordSize, 0, records->size());
+	}
+}
+
+
+void parSortRecordArray(RecordArray* records, RecordEngine engine, int32_t numThreads)
+{
+	if (records == nullptr || records->size() < 2)
+		return;
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, records->size()));
+	
+	if (engine == RecordEngine::Radix)
+		radixSortRecords(records, numThreads);
+	else
+		parMergeSortRecords(records, numThreads);
+}
@@ -0,0 +1,246 @@
+/**
+*  argsort.cpp
+*
+*  Defines argsort (the stable sorted order of a key column as a permutation, without moving the keys)
+*  on top of the key/index pair engines, and the parallel gather that applies it to side columns
+*/
+
+#include "recordSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+// Builds the key/index pairs for the positions [left..right)
+//
+static void packKeys(std::vector<int32_t>* keys, std::vector<uint64_t>* pairs, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		pairs->at(i) = packKeyIndex(keys->at(i), (uint32_t)i);
+	}
+}
+
+
+// Builds the (key, 64-bit index) records for the positions [left..right)
+//
+static void packWideKeys(std::vector<int32_t>* keys, RecordArray* records, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		uint8_t* record = records->bytes.data() + i * records->recordSize;
+		uint64_t index = i;
+		
+		std::memcpy(record, &(keys->at(i)), sizeof(int32_t));
+		std::memcpy(record + sizeof(int32_t), &index, sizeof(uint64_t));
+	}
+}
+
+
+// Copies the index of records[left..right) into 'order'
+//
+static void unpackWideOrder(RecordArray* records, std::vector<uint64_t>* order, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		std::memcpy(&(order->at(i)), records->bytes.data() + i * records->recordSize + sizeof(int32_t), sizeof(uint64_t));
+	}
+}
+
+
+// Copies the index half of pairs[left..right) into 'order', widening it to the index type of 'order'
+//
+template <typename Index>
+static void unpackOrder(std::vector<uint64_t>* pairs, std::vector<Index>* order, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		order->at(i) = (Index)unpackIndex(pairs->at(i));
+	}
+}
+
+
+// Runs 'work' over [0..n) split into one block per thread, or on this thread when 'numThreads' is 1
+//
+template <typename Work>
+static void forEachBlock(size_t n, int32_t numThreads, Work work)
+{
+	if (numThreads <= 1)
+	{
+		work((size_t)0, n);
+		return;
+	}
+	
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<std::thread> threads;
+	
+	for (size_t left = 0; left < n; left += blockSize)
+	{
+		threads.push_back(std::thread(work, left, std::min(left + blockSize, n)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+}
+
+
+template <typename Index>
+static void argsortKeys(std::vector<int32_t>* keys, std::vector<Index>* order, RecordEngine engine, int32_t numThreads)
+{
+	size_t n = keys->size();
+	
+	if (n > MAX_PACKED_ROWS)
+	{
+		throw std::length_error("Packed key/index pairs hold at most 2^32 keys");
+	}
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, n));
+	
+	/* Only the 8 byte pairs move through the merge or radix passes, never the data the keys belong to */
+	
+	std::vector<uint64_t> pairs(n);
+	
+	forEachBlock(n, numThreads, [&](size_t left, size_t right) { packKeys(keys, &pairs, left, right); });
+	
+	if (numThreads == 1)
+		seqSortKeyIndexPairs(&pairs, engine);
+	else
+		parSortKeyIndexPairs(&pairs, engine, numThreads);
+	
+	order->resize(n);
+	
+	forEachBlock(n, numThreads, [&](size_t left, size_t right) { unpackOrder(&pairs, order, left, right); });
+}
+
+
+// Sorts 12 byte (key, 64-bit index) records with the record engines, for columns too long for the packed
+// pairs. The engines are stable, so equal keys stay in the order of their positions
+//
+static void argsortWideKeys(std::vector<int32_t>* keys, std::vector<uint64_t>* order, RecordEngine engine, int32_t numThreads)
+{
+	size_t n = keys->size();
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, n));
+	
+	RecordArray records;
+	
+	records.recordSize = sizeof(int32_t) + sizeof(uint64_t);
+	records.bytes.resize(n * records.recordSize);
+	
+	forEachBlock(n, numThreads, [&](size_t left, size_t right) { packWideKeys(keys, &records, left, right); });
+	
+	if (numThreads == 1)
+		seqSortRecordArray(&records, engine);
+	else
+		parSortRecordArray(&records, engine, numThreads);
+	
+	order->resize(n);
+	
+	forEachBlock(n, numThreads, [&](size_t left, size_t right) { unpackWideOrder(&records, order, left, right); });
+}
+
+
+void seqArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order, RecordEngine engine)
+{
+	argsortKeys(keys, order, engine, 1);
+}
+
+void seqArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order, RecordEngine engine)
+{
+	if (keys->size() > MAX_PACKED_ROWS)
+		argsortWideKeys(keys, order, engine, 1);
+	else
+		argsortKeys(keys, order, engine, 1);
+}
+
+void parArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order, RecordEngine engine, int32_t numThreads)
+{
+	argsortKeys(keys, order, engine, numThreads);
+}
+
+void parArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order, RecordEngine engine, int32_t numThreads)
+{
+	if (keys->size() > MAX_PACKED_ROWS)
+		argsortWideKeys(keys, order, engine, numThreads);
+	else
+		argsortKeys(keys, order, engine, numThreads);
+}
+
+
+template <typename Index>
+static void gatherColumn(std::vector<Index>* order, const uint8_t* src, uint8_t* dst, size_t width, int32_t numThreads)
+{
+	size_t n = order->size();
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, n));
+	
+	forEachBlock(n, numThreads, [=](size_t left, size_t right)
+	{
+		for (size_t i = left; i < right; i++)
+		{
+			std::memcpy(dst + i * width, src + (size_t)order->at(i) * width, width);
+		}
+	});
+}
+
+
+void applyPermutation(std::vector<uint32_t>* order, const uint8_t* src, uint8_t* dst, size_t width, int32_t numThreads)
+{
+	gatherColumn(order, src, dst, width, numThreads);
+}
+
+void applyPermutation(std::vector<uint64_t>* order, const uint8_t* src, uint8_t* dst, size_t width, int32_t numThreads)
+{
+	gatherColumn(order, src, dst, width, numThreads);
+}
+
+
+template <typename Index>
+static bool checkArgsort(std::vector<int32_t>* keys, std::vector<Index>* order)
+{
+	size_t n = keys->size();
+	
+	if (order->size() != n)
+		return false;
+	
+	/* Every position has to appear exactly once */
+	
+	std::vector<bool> seen(n);
+	
+	for (Index index : *order)
+	{
+		if ((size_t)index >= n || seen[index])
+			return false;
+		
+		seen[index] = true;
+	}
+	
+	/* Keys in order, and equal keys in their original order */
+	
+	for (size_t i = 1; i < n; i++)
+	{
+		int32_t prev = keys->at(order->at(i - 1));
+		int32_t curr = keys->at(order->at(i));
+		
+		if (prev > curr || (prev == curr && order->at(i - 1) > order->at(i)))
+			return false;
+	}
+	
+	return true;
+}
+
+
+bool isStableArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order)
+{
+	return checkArgsort(keys, order);
+}
+
+bool isStableArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order)
+{
+	return checkArgsort(keys, order);
+}
@@ -0,0 +1,291 @@
+/**
+*  keyIndexSort.cpp
+*
+*  Defines the merge and radix engines for packed key/index pairs
+*/
+
+#include "recordSorts.hpp"
+#include "../CpuDispatch.hpp"
+
+#include <thread>
+#include <algorithm>
+
+
+const size_t SMALL_RUN = 32;
+const int RADIX_BITS = 8;
+const size_t RADIX_BUCKETS = 1 << RADIX_BITS;
+
+
+uint64_t packKeyIndex(int32_t key, uint32_t index)
+{
+	/* Flipping the sign bit makes unsigned order match signed key order */
+	
+	return ((uint64_t)((uint32_t)key ^ 0x80000000u) << 32) | index;
+}
+
+int32_t unpackKey(uint64_t pair)
+{
+	return (int32_t)((uint32_t)(pair >> 32) ^ 0x80000000u);
+}
+
+uint32_t unpackIndex(uint64_t pair)
+{
+	return (uint32_t)pair;
+}
+
+
+// Sorts pairs[left..right) with insertion sort
+//
+static void insertionSortPairs(uint64_t* pairs, size_t left, size_t right)
+{
+	for (size_t i = left + 1; i < right; i++)
+	{
+		uint64_t curr = pairs[i];
+		
+		size_t j;
+		
+		for (j = i; j > left && pairs[j - 1] > curr; j--)
+		{
+			pairs[j] = pairs[j - 1];
+		}
+		
+		pairs[j] = curr;
+	}
+}
+
+
+// Merges src[left..mid) and src[mid..right) into dst[left..right)
+//
+static void mergePairs(uint64_t* src, uint64_t* dst, size_t left, size_t mid, size_t right)
+{
+	size_t i = left;
+	size_t j = mid;
+	size_t k = left;
+	
+	while (i < mid && j < right)
+	{
+		dst[k++] = (src[i] <= src[j]) ? src[i++] : src[j++];
+	}
+	
+	while (i < mid)
+	{
+		dst[k++] = src[i++];
+	}
+	
+	while (j < right)
+	{
+		dst[k++] = src[j++];
+	}
+}
+
+
+// Bottom-up merge sort of pairs[left..right), using scratch[left..right) as the second buffer
+//
+static void mergeSortPairs(uint64_t* pairs, uint64_t* scratch, size_t left, size_t right)
+{
+	for (size_t run = left; run < right; run += SMALL_RUN)
+	{
+		insertionSortPairs(pairs, run, std::min(run + SMALL_RUN, right));
+	}
+	
+	uint64_t* src = pairs;
+	uint64_t* dst = scratch;
+	
+	for (size_t width = SMALL_RUN; width < right - left; width *= 2)
+	{
+		for (size_t l = left; l < right; l += 2 * width)
+		{
+			size_t m = std::min(l + width, right);
+			size_t r = std::min(l + 2 * width, right);
+			
+			mergePairs(src, dst, l, m, r);
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != pairs)
+	{
+		std::copy(src + left, src + right, pairs + left);
+	}
+}
+
+
+// Sorts each thread's block, then merges neighbouring blocks in parallel until one run is left
+//
+static void parMergeSortPairs(std::vector<uint64_t>* pairs, int32_t numThreads)
+{
+	size_t n = pairs->size();
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<uint64_t> scratch(n);
+	
+	uint64_t* src = pairs->data();
+	uint64_t* dst = scratch.data();
+	
+	std::vector<std::thread> threads;
+	
+	for (size_t left = 0; left < n; left += blockSize)
+	{
+		threads.push_back(std::thread(mergeSortPairs, src, dst, left, std::min(left + blockSize, n)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	for (size_t width = blockSize; width < n; width *= 2)
+	{
+		threads.clear();
+		
+		for (size_t l = 0; l < n; l += 2 * width)
+		{
+			size_t m = std::min(l + width, n);
+			size_t r = std::min(l + 2 * width, n);
+			
+			threads.push_back(std::thread(mergePairs, src, dst, l, m, r));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != pairs->data())
+	{
+		std::copy(src, src + n, pairs->data());
+	}
+}
+
+
+// Counts the radix digits of src[left..right) at 'shift'
+//
+static void countDigits(uint64_t* src, size_t left, size_t right, int shift, size_t* counts)
+{
+	countDigitsKernel(src + left, right - left, shift, RADIX_BUCKETS, counts);
+}
+
+
+// Moves src[left..right) to dst using the running bucket positions in 'offsets'
+//
+static void scatterDigits(uint64_t* src, uint64_t* dst, size_t left, size_t right, int shift, size_t* offsets)
+{
+	scatterDigitsKernel(src + left, dst, right - left, shift, RADIX_BUCKETS, offsets);
+}
+
+
+// LSD radix sort on the key half of each pair. Every pass is stable and the pairs start in index
+// order, so equal keys keep their original order without ever looking at the index half
+//
+static void radixSortPairs(std::vector<uint64_t>* pairs, int32_t numThreads)
+{
+	size_t n = pairs->size();
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<uint64_t> scratch(n);
+	
+	uint64_t* src = pairs->data();
+	uint64_t* dst = scratch.data();
+	
+	std::vector<std::vector<size_t>> counts(numThreads, std::vector<size_t>(RADIX_BUCKETS));
+	
+	for (int shift = 32; shift < 64; shift += RADIX_BITS)
+	{
+		std::vector<std::thread> threads;
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			std::fill(counts[t].begin(), counts[t].end(), 0);
+			
+			size_t left = std::min(t * blockSize, n);
+			size_t right = std::min(left + blockSize, n);
+			
+			if (numThreads == 1)
+				countDigits(src, left, right, shift, counts[t].data());
+			else
+				threads.push_back(std::thread(countDigits, src, left, right, shift, counts[t].data()));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		/* Turn the counts into starting positions: by digit, then by thread, which keeps the pass stable */
+		
+		size_t position = 0;
+		
+		for (size_t digit = 0; digit < RADIX_BUCKETS; digit++)
+		{
+			for (int32_t t = 0; t < numThreads; t++)
+			{
+				size_t count = counts[t][digit];
+				
+				counts[t][digit] = position;
+				
+				position += count;
+			}
+		}
+		
+		threads.clear();
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			size_t left = std::min(t * blockSize, n);
+			size_t right = std::min(left + blockSize, n);
+			
+			if (numThreads == 1)
+				scatterDigits(src, dst, left, right, shift, counts[t].data());
+			else
+				threads.push_back(std::thread(scatterDigits, src, dst, left, right, shift, counts[t].data()));
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != pairs->data())
+	{
+		std::copy(src, src + n, pairs->data());
+	}
+}
+
+
+void seqSortKeyIndexPairs(std::vector<uint64_t>* pairs, RecordEngine engine)
+{
+	if (pairs == nullptr || pairs->size() < 2)
+		return;
+	
+	if (engine == RecordEngine::Radix)
+	{
+		radixSortPairs(pairs, 1);
+	}
+	else
+	{
+		std::vector<uint64_t> scratch(pairs->size());
+		
+		mergeSortPairs(pairs->data(), scratch.data(), 0, pairs->size());
+	}
+}
+
+
+void parSortKeyIndexPairs(std::vector<uint64_t>* pairs, RecordEngine engine, int32_t numThreads)
+{
+	if (pairs == nullptr || pairs->size() < 2)
+		return;
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, pairs->size()));
+	
+	if (engine == RecordEngine::Radix)
+		radixSortPairs(pairs, numThreads);
+	else
+		parMergeSortPairs(pairs, numThreads);
+}
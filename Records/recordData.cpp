@@ -0,0 +1,173 @@
+/**
+*  recordData.cpp
+*
+*  Defines loading, layout conversion and verification of key/payload records
+*/
+
+#include "recordSorts.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <algorithm>
+#include <cstring>
+
+
+std::string getRecordLayoutName(RecordLayout layout)
+{
+	return (layout == RecordLayout::StructOfArrays) ? "struct of arrays" : "array of structs";
+}
+
+
+std::string getRecordEngineName(RecordEngine engine)
+{
+	return (engine == RecordEngine::Radix) ? "Radix" : "Merge";
+}
+
+
+void loadRecordFile(std::string fileName, size_t recordSize, RecordArray* records)
+{
+	std::ifstream dataFile(fileName, std::ios::binary | std::ios::ate);
+	
+	if (!dataFile.is_open())
+	{
+		std::cout << "\n   ERROR: Cannot open file \"" << fileName << "\"\n\n";
+		
+		exit(2);
+	}
+	
+	size_t fileSize = dataFile.tellg();
+	
+	if (fileSize % recordSize != 0)
+	{
+		std::cout << "\n   ERROR: Size of \"" << fileName << "\" (" << fileSize << " bytes) is not a multiple of the record size (" << recordSize << " bytes)\n\n";
+		
+		exit(2);
+	}
+	
+	records->recordSize = recordSize;
+	records->bytes.resize(fileSize);
+	
+	dataFile.seekg(0);
+	
+	if (!dataFile.read((char*)records->bytes.data(), fileSize))
+	{
+		std::cout << "\n   ERROR: Failure occured while reading from \"" << fileName << "\"\n\n";
+		
+		exit(2);
+	}
+}
+
+
+void splitRecordColumns(RecordArray* records, size_t columnWidth, RecordColumns* columns)
+{
+	size_t n = records->size();
+	size_t payloadSize = records->recordSize - sizeof(int32_t);
+	
+	columns->keys.resize(n);
+	columns->columnWidths.clear();
+	columns->columns.clear();
+	
+	for (size_t offset = 0; offset < payloadSize; offset += columnWidth)
+	{
+		size_t width = std::min(columnWidth, payloadSize - offset);
+		
+		columns->columnWidths.push_back(width);
+		columns->columns.push_back(std::vector<uint8_t>(n * width));
+	}
+	
+	for (size_t i = 0; i < n; i++)
+	{
+		uint8_t* record = records->bytes.data() + i * records->recordSize;
+		
+		std::memcpy(&(columns->keys[i]), record, sizeof(int32_t));
+		
+		size_t offset = sizeof(int32_t);
+		
+		for (size_t c = 0; c < columns->columns.size(); c++)
+		{
+			size_t width = columns->columnWidths[c];
+			
+			std::memcpy(columns->columns[c].data() + i * width, record + offset, width);
+			
+			offset += width;
+		}
+	}
+}
+
+
+// Gets the original positions of the records ordered the way a stable sort must leave them
+//
+static std::vector<size_t> getStableOrder(std::vector<int32_t>* keys)
+{
+	std::vector<size_t> order(keys->size());
+	
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	
+	std::stable_sort(order.begin(), order.end(), [keys](size_t a, size_t b) { return keys->at(a) < keys->at(b); });
+	
+	return order;
+}
+
+
+bool isStablySorted(RecordArray* sorted, RecordArray* original)
+{
+	size_t n = original->size();
+	size_t recordSize = original->recordSize;
+	
+	if (sorted->size() != n || sorted->recordSize != recordSize)
+		return false;
+	
+	std::vector<int32_t> keys(n);
+	
+	for (size_t i = 0; i < n; i++)
+	{
+		std::memcpy(&keys[i], original->bytes.data() + i * recordSize, sizeof(int32_t));
+	}
+	
+	std::vector<size_t> order = getStableOrder(&keys);
+	
+	for (size_t i = 0; i < n; i++)
+	{
+		if (std::memcmp(sorted->bytes.data() + i * recordSize, original->bytes.data() + order[i] * recordSize, recordSize) != 0)
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+
+bool isStablySorted(RecordColumns* sorted, RecordColumns* original)
+{
+	size_t n = original->size();
+	
+	if (sorted->size() != n || sorted->columns.size() != original->columns.size())
+		return false;
+	
+	std::vector<size_t> order = getStableOrder(&(original->keys));
+	
+	for (size_t i = 0; i < n; i++)
+	{
+		if (sorted->keys[i] != original->keys[order[i]])
+		{
+			return false;
+		}
+		
+		for (size_t c = 0; c < original->columns.size(); c++)
+		{
+			size_t width = original->columnWidths[c];
+			
+			if (std::memcmp(sorted->columns[c].data() + i * width, original->columns[c].data() + order[i] * width, width) != 0)
+			{
+				return false;
+			}
+		}
+	}
+	
+	return true;
+}
@@ -0,0 +1,125 @@
+/**
+*  recordSorts.hpp
+*
+*  Declares the stable key/payload record sorting functions
+*/
+
+#ifndef RECORD_SORTS_HPP_MULTITHREADED_SORTING
+#define RECORD_SORTS_HPP_MULTITHREADED_SORTING
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+/*** Constants ***/
+
+const size_t MAX_PACKED_ROWS = UINT32_MAX;		// Most rows the 32-bit index of a key/index pair can address
+
+
+/*** Data Structures ***/
+
+enum class RecordLayout
+{
+	ArrayOfStructs,
+	StructOfArrays
+};
+
+enum class RecordEngine
+{
+	Merge,
+	Radix
+};
+
+// Array of structs: every record is 'recordSize' bytes, starting with its int32_t key
+//
+struct RecordArray
+{
+	size_t recordSize{};
+	std::vector<uint8_t> bytes;
+	
+	size_t size() { return (recordSize) ? bytes.size() / recordSize : 0; }
+};
+
+// Struct of arrays: the keys in one column and the payload split into fixed width columns
+//
+struct RecordColumns
+{
+	std::vector<int32_t> keys;
+	std::vector<size_t> columnWidths;
+	std::vector<std::vector<uint8_t>> columns;
+	
+	size_t size() { return keys.size(); }
+};
+
+
+/*** Record Data (recordData.cpp) ***/
+
+// Gets the display names of the record layouts and engines
+//
+std::string getRecordLayoutName(RecordLayout layout);
+std::string getRecordEngineName(RecordEngine engine);
+
+// Reads fixed width binary records (little endian int32_t key followed by the payload) from 'fileName'
+//
+void loadRecordFile(std::string fileName, size_t recordSize, RecordArray* records);
+
+// Copies 'records' into struct of arrays form, splitting the payload into columns of at most 'columnWidth' bytes
+//
+void splitRecordColumns(RecordArray* records, size_t columnWidth, RecordColumns* columns);
+
+// Checks that 'sorted' holds the records of 'original' ordered by key, with equal keys in their original order
+//
+bool isStablySorted(RecordArray* sorted, RecordArray* original);
+bool isStablySorted(RecordColumns* sorted, RecordColumns* original);
+
+
+/*** Key/Index Pairs (keyIndexSort.cpp) ***/
+
+// Packs a key and its position so that ordering the 64-bit words orders by key, then by position
+//
+uint64_t packKeyIndex(int32_t key, uint32_t index);
+int32_t unpackKey(uint64_t pair);
+uint32_t unpackIndex(uint64_t pair);
+
+void seqSortKeyIndexPairs(std::vector<uint64_t>* pairs, RecordEngine engine);
+void parSortKeyIndexPairs(std::vector<uint64_t>* pairs, RecordEngine engine, int32_t numThreads);
+
+
+/*** Argsort (argsort.cpp) ***/
+
+// Sets 'order' to the positions of 'keys' in stably sorted order (keys[order[0]] is the smallest), using
+// the key/index pair engines, without moving the keys. 32-bit orders hold at most 2^32 keys. Longer
+// columns need a 64-bit order, and are sorted as 12 byte (key, 64-bit index) records instead of pairs
+//
+void seqArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order, RecordEngine engine);
+void seqArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order, RecordEngine engine);
+void parArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order, RecordEngine engine, int32_t numThreads);
+void parArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order, RecordEngine engine, int32_t numThreads);
+
+// Gathers a side column of fixed width values into sorted order: row i of 'dst' is row order[i] of 'src'
+//
+void applyPermutation(std::vector<uint32_t>* order, const uint8_t* src, uint8_t* dst, size_t width, int32_t numThreads);
+void applyPermutation(std::vector<uint64_t>* order, const uint8_t* src, uint8_t* dst, size_t width, int32_t numThreads);
+
+// Checks that 'order' is a permutation of the positions of 'keys' that sorts them stably
+//
+bool isStableArgsort(std::vector<int32_t>* keys, std::vector<uint32_t>* order);
+bool isStableArgsort(std::vector<int32_t>* keys, std::vector<uint64_t>* order);
+
+
+/*** Array of Structs (aosRecordSort.cpp) ***/
+
+void seqSortRecordArray(RecordArray* records, RecordEngine engine);
+void parSortRecordArray(RecordArray* records, RecordEngine engine, int32_t numThreads);
+
+
+/*** Struct of Arrays (soaRecordSort.cpp) ***/
+
+void seqSortRecordColumns(RecordColumns* columns, RecordEngine engine);
+void parSortRecordColumns(RecordColumns* columns, RecordEngine engine, int32_t numThreads);
+
+
+#endif
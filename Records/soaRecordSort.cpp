@@ -0,0 +1,139 @@
+/**
+*  soaRecordSort.cpp
+*
+*  Defines the stable sort for struct of arrays records: the key column is sorted as packed
+*  key/index pairs, then every column is permuted to match
+*/
+
+#include "recordSorts.hpp"
+
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+// Builds the key/index pairs for the rows [left..right)
+//
+static void packRows(RecordColumns* columns, std::vector<uint64_t>* pairs, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		pairs->at(i) = packKeyIndex(columns->keys[i], (uint32_t)i);
+	}
+}
+
+
+// Writes the sorted rows [left..right) of every column into 'sorted', one column at a time
+//
+static void gatherRows(RecordColumns* columns, RecordColumns* sorted, std::vector<uint64_t>* pairs, size_t left, size_t right)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		sorted->keys[i] = unpackKey(pairs->at(i));
+	}
+	
+	for (size_t c = 0; c < columns->columns.size(); c++)
+	{
+		size_t width = columns->columnWidths[c];
+		
+		uint8_t* src = columns->columns[c].data();
+		uint8_t* dst = sorted->columns[c].data();
+		
+		for (size_t i = left; i < right; i++)
+		{
+			std::memcpy(dst + i * width, src + unpackIndex(pairs->at(i)) * width, width);
+		}
+	}
+}
+
+
+// Sorts the key column and permutes the payload columns, splitting the rows over 'numThreads' threads
+//
+static void sortColumns(RecordColumns* columns, RecordEngine engine, int32_t numThreads)
+{
+	size_t n = columns->size();
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	if (n > MAX_PACKED_ROWS)
+	{
+		throw std::length_error("Packed key/index pairs hold at most 2^32 rows");
+	}
+	
+	std::vector<uint64_t> pairs(n);
+	
+	std::vector<std::thread> threads;
+	
+	for (size_t left = 0; left < n && numThreads > 1; left += blockSize)
+	{
+		threads.push_back(std::thread(packRows, columns, &pairs, left, std::min(left + blockSize, n)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	if (numThreads == 1)
+	{
+		packRows(columns, &pairs, 0, n);
+		
+		seqSortKeyIndexPairs(&pairs, engine);
+	}
+	else
+	{
+		parSortKeyIndexPairs(&pairs, engine, numThreads);
+	}
+	
+	/* Gather into new columns, then swap them in */
+	
+	RecordColumns sorted;
+	
+	sorted.keys.resize(n);
+	sorted.columnWidths = columns->columnWidths;
+	
+	for (size_t c = 0; c < columns->columns.size(); c++)
+	{
+		sorted.columns.push_back(std::vector<uint8_t>(columns->columns[c].size()));
+	}
+	
+	threads.clear();
+	
+	for (size_t left = 0; left < n && numThreads > 1; left += blockSize)
+	{
+		threads.push_back(std::thread(gatherRows, columns, &sorted, &pairs, left, std::min(left + blockSize, n)));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	if (numThreads == 1)
+	{
+		gatherRows(columns, &sorted, &pairs, 0, n);
+	}
+	
+	columns->keys.swap(sorted.keys);
+	columns->columns.swap(sorted.columns);
+}
+
+
+void seqSortRecordColumns(RecordColumns* columns, RecordEngine engine)
+{
+	if (columns == nullptr || columns->size() < 2)
+		return;
+	
+	sortColumns(columns, engine, 1);
+}
+
+
+void parSortRecordColumns(RecordColumns* columns, RecordEngine engine, int32_t numThreads)
+{
+	if (columns == nullptr || columns->size() < 2)
+		return;
+	
+	numThreads = (int32_t)std::max<size_t>(1, std::min<size_t>(numThreads, columns->size()));
+	
+	sortColumns(columns, engine, numThreads);
+}
@@ -0,0 +1,437 @@
+/**
+*  Regression.cpp
+*
+*  Defines the performance regression gate, which times a suite of cases and compares them to a stored baseline
+*/
+
+#include "Regression.hpp"
+#include "Stopwatch.hpp"
+#include "ResultsLog.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+
+/*** Constants ***/
+
+// Two-sided 95% critical values of Student's t distribution for 1 to 30 degrees of freedom
+//
+const double T_CRITICAL_95[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+
+
+
+/*** Function Definitions ***/
+
+std::string getRegressionCaseKey(BatchJob* job)
+{
+	std::string key = job->dataFile + " " + getAlgorithmKey(job->algorithm);
+	
+	if (job->parallel)
+		key += " par " + std::to_string(job->numThreads);
+	else
+		key += " seq";
+	
+	return key;
+}
+
+
+// Fills in the mean and sample standard deviation of the throughputs of 'c'
+//
+static void computeThroughputStats(RegressionCase* c)
+{
+	size_t n = c->throughputs.size();
+	
+	c->meanThroughput = 0.0;
+	c->stddevThroughput = 0.0;
+	
+	if (n == 0)
+		return;
+	
+	for (double t : c->throughputs)
+		c->meanThroughput += t;
+	
+	c->meanThroughput /= n;
+	
+	if (n < 2)
+		return;
+	
+	double sumSquares = 0.0;
+	
+	for (double t : c->throughputs)
+		sumSquares += (t - c->meanThroughput) * (t - c->meanThroughput);
+	
+	c->stddevThroughput = std::sqrt(sumSquares / (n - 1));
+}
+
+
+void runRegressionSuite(std::vector<BatchJob>* jobs, int32_t trials, bool verify, std::vector<RegressionCase>* cases)
+{
+	cases->assign(jobs->size(), RegressionCase());
+	
+	for (size_t j = 0; j < jobs->size(); j++)
+	{
+		RegressionCase* c = &(cases->at(j));
+		
+		c->job = jobs->at(j);
+		
+		std::cout << " [" << (j + 1) << "/" << jobs->size() << "] " << getRegressionCaseKey(&(c->job)) << ": " << std::flush;
+		
+		std::vector<int32_t> input;
+		
+		if (!readTestData(c->job.dataFile, &input, &(c->error)))
+		{
+			c->loaded = false;
+			
+			std::cout << "(ERROR) " << c->error << "\n";
+			continue;
+		}
+		
+		c->dataLength = input.size();
+		c->verified = verify;
+		c->sortedCorrectly = true;
+		
+		SortParameters param{};
+		
+		param.dataFile = c->job.dataFile;
+		param.algorithm = c->job.algorithm;
+		param.parallel = c->job.parallel;
+		param.numThreads = c->job.numThreads;
+		
+		param.data = input;
+		
+		runSortingAlgorithm(&param);
+		
+		for (int32_t trial = 0; trial < trials; trial++)
+		{
+			param.data = input;
+			
+			Stopwatch timer;
+			timer.start();
+			
+			runSortingAlgorithm(&param);
+			
+			timer.stop();
+			
+			double seconds = std::max(timer.getSeconds(), 1e-9);
+			
+			c->throughputs.push_back(c->dataLength / seconds);
+			
+			if (verify && !isSorted(&(param.data)))
+			{
+				c->sortedCorrectly = false;
+			}
+		}
+		
+		computeThroughputStats(c);
+		
+		std::cout << std::fixed << std::setprecision(3) << (c->meanThroughput / 1e6) << " M values/s (+/- "
+		          << (c->stddevThroughput / 1e6) << ")" << ((verify && !c->sortedCorrectly) ? "  (WARNING: not sorted)" : "") << "\n";
+	}
+}
+
+
+bool writeBaselineJSON(std::vector<RegressionCase>* cases, std::string timestamp, std::string fileName)
+{
+	std::ofstream json(fileName);
+	
+	if (!json.is_open())
+	{
+		return false;
+	}
+	
+	json << std::setprecision(3) << std::fixed;
+	
+	json << "{\n";
+	json << "  \"timestamp\": " << jsonString(timestamp) << ",\n";
+	json << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "  \"cases\": [\n";
+	
+	/* One case per line, which is what readBaselineJSON() expects */
+	
+	bool first = true;
+	
+	for (RegressionCase& c : *cases)
+	{
+		if (!c.loaded)
+			continue;
+		
+		json << ((first) ? "" : ",\n");
+		json << "    {"
+		     << "\"dataset\": " << jsonString(c.job.dataFile) << ", "
+		     << "\"algorithm\": " << jsonString(getAlgorithmKey(c.job.algorithm)) << ", "
+		     << "\"parallel\": " << ((c.job.parallel) ? "true" : "false") << ", "
+		     << "\"threads\": " << ((c.job.parallel) ? c.job.numThreads : 1) << ", "
+		     << "\"size\": " << c.dataLength << ", "
+		     << "\"mean_throughput\": " << c.meanThroughput << ", "
+		     << "\"stddev_throughput\": " << c.stddevThroughput << ", "
+		     << "\"throughputs\": [";
+		
+		for (size_t i = 0; i < c.throughputs.size(); i++)
+		{
+			json << ((i) ? ", " : "") << c.throughputs[i];
+		}
+		
+		json << "]}";
+		
+		first = false;
+	}
+	
+	json << "\n  ]\n";
+	json << "}\n";
+	
+	return true;
+}
+
+
+// Finds the value of '"key": ' in 'line' and places its text in 'value' (without the quotes for strings,
+// without the brackets for arrays). Returns false if the key is missing
+//
+static bool findJsonValue(std::string line, std::string key, std::string* value)
+{
+	size_t pos = line.find("\"" + key + "\":");
+	
+	if (pos == std::string::npos)
+		return false;
+	
+	pos = line.find_first_not_of(' ', pos + key.size() + 3);
+	
+	if (pos == std::string::npos)
+		return false;
+	
+	value->clear();
+	
+	if (line[pos] == '"')
+	{
+		for (pos++; pos < line.size() && line[pos] != '"'; pos++)
+		{
+			if (line[pos] == '\\' && pos + 1 < line.size())
+			{
+				pos++;
+				
+				*value += (line[pos] == 'n') ? '\n' : line[pos];
+			}
+			else
+			{
+				*value += line[pos];
+			}
+		}
+	}
+	else if (line[pos] == '[')
+	{
+		size_t end = line.find(']', pos);
+		
+		if (end == std::string::npos)
+			return false;
+		
+		*value = line.substr(pos + 1, end - pos - 1);
+	}
+	else
+	{
+		size_t end = line.find_first_of(",}", pos);
+		
+		*value = line.substr(pos, end - pos);
+	}
+	
+	return true;
+}
+
+
+bool readBaselineJSON(std::string fileName, std::vector<RegressionCase>* cases, std::string* error)
+{
+	std::ifstream json(fileName);
+	
+	if (!json.is_open())
+	{
+		*error = "Cannot open baseline \"" + fileName + "\"";
+		return false;
+	}
+	
+	std::string line;
+	int32_t lineNumber = 0;
+	
+	while (std::getline(json, line))
+	{
+		lineNumber++;
+		
+		if (line.find("\"dataset\":") == std::string::npos)
+			continue;
+		
+		RegressionCase c;
+		std::string algorithm, parallel, threads, size, throughputs;
+		
+		if (!findJsonValue(line, "dataset", &(c.job.dataFile)) || !findJsonValue(line, "algorithm", &algorithm)
+		    || !findJsonValue(line, "parallel", &parallel) || !findJsonValue(line, "threads", &threads)
+		    || !findJsonValue(line, "size", &size) || !findJsonValue(line, "throughputs", &throughputs))
+		{
+			*error = "Missing field on line " + std::to_string(lineNumber) + " of baseline \"" + fileName + "\"";
+			return false;
+		}
+		
+		c.job.algorithm = parseAlgorithmName(algorithm);
+		c.job.parallel = (parallel == "true");
+		
+		try
+		{
+			c.job.numThreads = std::stoi(threads);
+			c.dataLength = std::stoull(size);
+			
+			std::stringstream values(throughputs);
+			std::string value;
+			
+			while (std::getline(values, value, ','))
+			{
+				c.throughputs.push_back(std::stod(value));
+			}
+		}
+		catch (std::exception const& e)
+		{
+			*error = "Invalid number on line " + std::to_string(lineNumber) + " of baseline \"" + fileName + "\"";
+			return false;
+		}
+		
+		if (c.job.algorithm == SortAlgorithm::None || c.throughputs.empty())
+		{
+			*error = "Invalid case on line " + std::to_string(lineNumber) + " of baseline \"" + fileName + "\"";
+			return false;
+		}
+		
+		computeThroughputStats(&c);
+		
+		cases->push_back(c);
+	}
+	
+	return true;
+}
+
+
+// Gets the two-sided 95% critical value of Student's t distribution for 'df' degrees of freedom
+//
+static double tCritical95(double df)
+{
+	if (df < 1.0)
+		return T_CRITICAL_95[0];
+	else if (df <= 30.0)
+		return T_CRITICAL_95[(int32_t)df - 1];
+	else if (df <= 60.0)
+		return 2.000;
+	else if (df <= 120.0)
+		return 1.980;
+	
+	return 1.960;
+}
+
+
+// Fills in the relative change of 'comparison' and its 95% confidence interval, using Welch's t-interval
+// for the difference of the mean throughputs (the trials of the two runs may have different variances)
+//
+static void computeChange(RegressionComparison* comparison)
+{
+	RegressionCase* base = &(comparison->baseline);
+	RegressionCase* now = &(comparison->current);
+	
+	double difference = now->meanThroughput - base->meanThroughput;
+	
+	comparison->change = difference / base->meanThroughput;
+	
+	double n1 = base->throughputs.size();
+	double n2 = now->throughputs.size();
+	
+	/* A single trial has no spread to build an interval from, so only the point estimate is used */
+	
+	if (n1 < 2 || n2 < 2)
+	{
+		comparison->changeLow = comparison->changeHigh = comparison->change;
+		return;
+	}
+	
+	double v1 = base->stddevThroughput * base->stddevThroughput / n1;
+	double v2 = now->stddevThroughput * now->stddevThroughput / n2;
+	
+	double standardError = std::sqrt(v1 + v2);
+	double df = (v1 + v2 > 0.0) ? (v1 + v2) * (v1 + v2) / (v1 * v1 / (n1 - 1) + v2 * v2 / (n2 - 1)) : n1 + n2 - 2;
+	
+	double margin = tCritical95(df) * standardError;
+	
+	comparison->changeLow = (difference - margin) / base->meanThroughput;
+	comparison->changeHigh = (difference + margin) / base->meanThroughput;
+}
+
+
+void compareToBaseline(std::vector<RegressionCase>* current, std::vector<RegressionCase>* baseline, int32_t threshold, std::vector<RegressionComparison>* comparisons)
+{
+	double limit = threshold / 100.0;
+	
+	for (RegressionCase& c : *current)
+	{
+		RegressionComparison comparison;
+		comparison.current = c;
+		
+		std::string key = getRegressionCaseKey(&(c.job));
+		
+		auto found = std::find_if(baseline->begin(), baseline->end(), [&](RegressionCase& b) { return getRegressionCaseKey(&(b.job)) == key; });
+		
+		if (!c.loaded || (c.verified && !c.sortedCorrectly))
+		{
+			comparison.status = RegressionStatus::Failed;
+		}
+		else if (found == baseline->end())
+		{
+			comparison.status = RegressionStatus::New;
+		}
+		else
+		{
+			comparison.baseline = *found;
+			
+			if (found->dataLength != c.dataLength)
+			{
+				comparison.status = RegressionStatus::Changed;
+			}
+			else
+			{
+				computeChange(&comparison);
+				
+				/* The mean change has to pass the threshold, and the interval has to rule out no change at
+				   all. Requiring the whole interval past the threshold would let a noisy case lose far
+				   more than the threshold without ever being flagged */
+				
+				if (comparison.change < -limit && comparison.changeHigh < 0.0)
+					comparison.status = RegressionStatus::Regressed;
+				else if (comparison.change > limit && comparison.changeLow > 0.0)
+					comparison.status = RegressionStatus::Improved;
+				else
+					comparison.status = RegressionStatus::Unchanged;
+			}
+		}
+		
+		comparisons->push_back(comparison);
+	}
+}
+
+
+std::string getRegressionStatusName(RegressionStatus status)
+{
+	switch (status)
+	{
+		case RegressionStatus::Unchanged:
+			return "ok";
+		case RegressionStatus::Regressed:
+			return "REGRESSED";
+		case RegressionStatus::Improved:
+			return "improved";
+		case RegressionStatus::New:
+			return "new (not in baseline)";
+		case RegressionStatus::Changed:
+			return "dataset changed";
+		case RegressionStatus::Failed:
+			return "FAILED";
+		default:
+			return "";
+	}
+}
@@ -0,0 +1,99 @@
+/**
+*  Regression.hpp
+*
+*  Declares the performance regression gate, which times a suite of cases and compares them to a stored baseline
+*/
+
+#ifndef REGRESSION_HPP_MULTITHREADED_SORTING
+#define REGRESSION_HPP_MULTITHREADED_SORTING
+
+
+#include "Batch.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+/*** Constants ***/
+
+const int32_t DEFAULT_REGRESSION_TRIALS = 10;
+const int32_t DEFAULT_REGRESSION_THRESHOLD = 5;	// Percent of throughput a case may lose before the gate fails
+
+
+
+/*** Data Structures ***/
+
+// One (dataset, algorithm, parallel flag, thread count) case of the suite and its timed runs
+//
+struct RegressionCase
+{
+	BatchJob job;
+	
+	size_t dataLength{};
+	std::vector<double> throughputs;	// Values sorted per second, one per trial
+	double meanThroughput{};
+	double stddevThroughput{};			// Sample standard deviation of 'throughputs'
+	
+	bool loaded = true;
+	std::string error;					// Why the file could not be loaded
+	
+	bool verified{};
+	bool sortedCorrectly{};
+};
+
+enum class RegressionStatus
+{
+	Unchanged,	// Any change is within the threshold or not significant
+	Regressed,	// Mean throughput dropped by more than the threshold, and the 95% interval excludes no change
+	Improved,	// Mean throughput rose by more than the threshold, and the 95% interval excludes no change
+	New,		// Not in the baseline
+	Changed,	// The dataset length differs from the baseline, so the times cannot be compared
+	Failed		// Could not be loaded, or was not sorted correctly
+};
+
+struct RegressionComparison
+{
+	RegressionCase current;
+	RegressionCase baseline;
+	
+	double change{};		// Relative change of the mean throughput (-0.10 is 10% slower)
+	double changeLow{};		// 95% confidence interval of 'change' (Welch's t-interval)
+	double changeHigh{};
+	
+	RegressionStatus status{};
+};
+
+
+
+/*** Function Declarations ***/
+
+// Gets the key that identifies a case between runs (ex. "TestData/Large.dat merge par 4")
+//
+std::string getRegressionCaseKey(BatchJob* job);
+
+// Loads every case of 'jobs', sorts it once untimed to warm up the caches and allocator, then times it
+// 'trials' times on a fresh copy of its data each time.
+// Results are placed in 'cases' in the order of 'jobs'
+//
+void runRegressionSuite(std::vector<BatchJob>* jobs, int32_t trials, bool verify, std::vector<RegressionCase>* cases);
+
+// Saves the cases, with every trial, as a baseline ".json" file
+//
+bool writeBaselineJSON(std::vector<RegressionCase>* cases, std::string timestamp, std::string fileName);
+
+// Reads the cases of a baseline written by writeBaselineJSON(). Returns false and sets 'error' if it fails
+//
+bool readBaselineJSON(std::string fileName, std::vector<RegressionCase>* cases, std::string* error);
+
+// Compares every case of 'current' to the matching case of 'baseline'. A case regresses when the whole
+// 95% confidence interval of its throughput change lies below -'threshold' percent
+//
+void compareToBaseline(std::vector<RegressionCase>* current, std::vector<RegressionCase>* baseline, int32_t threshold, std::vector<RegressionComparison>* comparisons);
+
+// Gets the display name of 'status' (ex. "REGRESSED")
+//
+std::string getRegressionStatusName(RegressionStatus status);
+
+
+#endif
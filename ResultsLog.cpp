@@ -0,0 +1,223 @@
+/**
+*  ResultsLog.cpp
+*
+*  Defines the structured results log: one JSON object per run, with a fingerprint of the machine and
+*  build it ran on, appended to a ".jsonl" file
+*/
+
+#include "ResultsLog.hpp"
+#include "CpuDispatch.hpp"
+#include "MemoryInfo.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/utsname.h>
+
+
+/* Written by the Makefile, builds without it record the revision and flags as "unknown" */
+
+#if __has_include("GitRevision.hpp")
+#include "GitRevision.hpp"
+#endif
+
+#ifndef GIT_REVISION
+#define GIT_REVISION "unknown"
+#endif
+
+#ifndef BUILD_FLAGS
+#define BUILD_FLAGS "unknown"
+#endif
+
+
+
+/*** Function Definitions ***/
+
+// Gets the value of the first "key : value" line of /proc/cpuinfo whose key is 'key'
+//
+static std::string getCpuInfoValue(std::string key)
+{
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	
+	while (std::getline(cpuinfo, line))
+	{
+		size_t colon = line.find(':');
+		
+		if (colon == std::string::npos || line.compare(0, key.size(), key) != 0)
+			continue;
+		
+		size_t start = line.find_first_not_of(" \t", colon + 1);
+		
+		return (start == std::string::npos) ? "" : line.substr(start);
+	}
+	
+	return "unknown";
+}
+
+
+// Gets the first line of 'fileName', or "unknown" if it cannot be read
+//
+static std::string readFirstLine(std::string fileName)
+{
+	std::ifstream file(fileName);
+	std::string line;
+	
+	if (!std::getline(file, line))
+		return "unknown";
+	
+	return line;
+}
+
+
+std::string jsonString(std::string s)
+{
+	std::string escaped = "\"";
+	
+	for (char c : s)
+	{
+		if (c == '"' || c == '\\')
+		{
+			escaped += '\\';
+			escaped += c;
+		}
+		else if (c == '\n')
+		{
+			escaped += "\\n";
+		}
+		else if ((unsigned char)c < 0x20)
+		{
+			char code[8];
+			
+			snprintf(code, sizeof(code), "\\u%04x", c);
+			
+			escaped += code;
+		}
+		else
+		{
+			escaped += c;
+		}
+	}
+	
+	escaped += "\"";
+	
+	return escaped;
+}
+
+
+std::string getUTCTimestamp()
+{
+	time_t now = time(nullptr);
+	struct tm utc;
+	char text[32];
+	
+	gmtime_r(&now, &utc);
+	strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%SZ", &utc);
+	
+	return text;
+}
+
+
+EnvironmentInfo getEnvironmentInfo()
+{
+	EnvironmentInfo env;
+	
+	char hostname[256] = {};
+	
+	env.hostname = (gethostname(hostname, sizeof(hostname) - 1) == 0) ? hostname : "unknown";
+	
+	env.cpuModel = getCpuInfoValue("model name");
+	env.hardwareThreads = std::thread::hardware_concurrency();
+	env.governor = readFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+	
+	struct utsname name;
+	
+	env.kernel = (uname(&name) == 0) ? std::string(name.release) + " " + name.version : "unknown";
+	
+	env.cpuPath = getCpuPathName(getCpuPath());
+	env.hugePages = getTransparentHugePageMode();
+
+#if defined(__clang__)
+	env.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+	env.compiler = "g++ " __VERSION__;
+#else
+	env.compiler = "unknown";
+#endif
+	
+	env.buildFlags = BUILD_FLAGS;
+	env.gitRevision = GIT_REVISION;
+	
+	if (env.gitRevision == "")
+		env.gitRevision = "unknown";
+	
+	return env;
+}
+
+
+std::string getEnvironmentJSON(EnvironmentInfo* env)
+{
+	std::stringstream json;
+	
+	json << "{"
+	     << "\"hostname\": " << jsonString(env->hostname) << ", "
+	     << "\"cpu_model\": " << jsonString(env->cpuModel) << ", "
+	     << "\"hardware_threads\": " << env->hardwareThreads << ", "
+	     << "\"governor\": " << jsonString(env->governor) << ", "
+	     << "\"kernel\": " << jsonString(env->kernel) << ", "
+	     << "\"cpu_path\": " << jsonString(env->cpuPath) << ", "
+	     << "\"huge_pages\": " << jsonString(env->hugePages) << ", "
+	     << "\"compiler\": " << jsonString(env->compiler) << ", "
+	     << "\"build_flags\": " << jsonString(env->buildFlags) << ", "
+	     << "\"git_revision\": " << jsonString(env->gitRevision) << "}";
+	
+	return json.str();
+}
+
+
+bool appendJSONLine(std::string fileName, std::string line)
+{
+	int fd = open(fileName.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+	
+	if (fd < 0)
+	{
+		return false;
+	}
+	
+	/* O_APPEND puts every write at the end of the file, and the lock keeps a write that the kernel
+	   splits from being interleaved with another process's line */
+	
+	line += '\n';
+	
+	bool written = (flock(fd, LOCK_EX) == 0);
+	
+	const char* data = line.data();
+	size_t remaining = line.size();
+	
+	while (written && remaining > 0)
+	{
+		ssize_t count = write(fd, data, remaining);
+		
+		if (count < 0 && errno == EINTR)
+			continue;
+		
+		written = (count > 0);
+		
+		if (written)
+		{
+			data += count;
+			remaining -= count;
+		}
+	}
+	
+	flock(fd, LOCK_UN);
+	
+	return (close(fd) == 0) && written;
+}
@@ -0,0 +1,65 @@
+/**
+*  ResultsLog.hpp
+*
+*  Declares the structured results log: one JSON object per run, with a fingerprint of the machine and
+*  build it ran on, appended to a ".jsonl" file
+*/
+
+#ifndef RESULTS_LOG_HPP_MULTITHREADED_SORTING
+#define RESULTS_LOG_HPP_MULTITHREADED_SORTING
+
+
+#include <string>
+#include <cstdint>
+
+
+/*** Constants ***/
+
+const std::string DEFAULT_RESULTS_LOG = "results.jsonl";
+
+
+
+/*** Data Structures ***/
+
+struct EnvironmentInfo
+{
+	std::string hostname;
+	std::string cpuModel;		// "model name" from /proc/cpuinfo
+	int32_t hardwareThreads{};
+	std::string governor;		// cpufreq scaling governor of CPU 0
+	std::string kernel;			// Kernel release and version from uname()
+	std::string cpuPath;		// Instruction set the dispatched kernels run on
+	std::string hugePages;		// Transparent huge page mode
+	
+	std::string compiler;
+	std::string buildFlags;		// Compile flags written by the Makefile ("unknown" for other builds)
+	std::string gitRevision;	// Revision the binary was built from ("unknown" outside of a git checkout)
+};
+
+
+
+/*** Function Declarations ***/
+
+// Gets 's' as a quoted JSON string, escaping the characters that cannot appear inside one
+//
+std::string jsonString(std::string s);
+
+// Gets the current time as an ISO-8601 UTC timestamp (ex. "2026-10-19T13:48:23Z")
+//
+std::string getUTCTimestamp();
+
+// Gathers the fingerprint of this machine and build. Settings the system does not expose are "unknown"
+//
+EnvironmentInfo getEnvironmentInfo();
+
+// Gets 'env' as one JSON object
+//
+std::string getEnvironmentJSON(EnvironmentInfo* env);
+
+// Appends 'line' and a newline to 'fileName' with a single write under an exclusive lock, so the lines of
+// runs that finish at the same time never interleave. Returns false if it fails
+//
+bool appendJSONLine(std::string fileName, std::string line);
+
+
+#endif
@@ -0,0 +1,178 @@
+/**
+*  seqBlockMergeSort.cpp
+*
+*  Defines the sequential cache-blocked bottom-up Merge Sort function
+*/
+
+#include "seqSorts.hpp"
+#include "../CpuDispatch.hpp"
+
+#include <algorithm>
+
+
+const size_t SMALL_SORT_SIZE = 32;
+
+
+// Sorts 'tile' in place: insertion sorts runs of SMALL_SORT_SIZE values, then merges them bottom-up
+// through 'scratch' (same length). Both are meant to fit in L2 so no pass goes out to DRAM
+//
+void sortTile(int32_t* tile, int32_t* scratch, size_t length)
+{
+	for (size_t begin = 0; begin < length; begin += SMALL_SORT_SIZE)
+	{
+		smallSortKernel(tile + begin, tile + std::min(begin + SMALL_SORT_SIZE, length));
+	}
+	
+	int32_t* src = tile;
+	int32_t* dst = scratch;
+	
+	for (size_t width = SMALL_SORT_SIZE; width < length; width *= 2)
+	{
+		for (size_t left = 0; left < length; left += 2 * width)
+		{
+			size_t mid = std::min(left + width, length);
+			size_t right = std::min(left + 2 * width, length);
+			
+			std::merge(src + left, src + mid, src + mid, src + right, dst + left);
+		}
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != tile)
+	{
+		std::copy(src, src + length, tile);
+	}
+}
+
+
+// Merges the sorted runs [begins[r]..ends[r]) into 'out' in one pass, using a min-heap of the runs
+// ordered by their next value
+//
+void multiwayMerge(std::vector<const int32_t*> begins, std::vector<const int32_t*> ends, int32_t* out)
+{
+	std::vector<size_t> heap;
+	
+	for (size_t r = 0; r < begins.size(); r++)
+	{
+		if (begins[r] != ends[r])
+			heap.push_back(r);
+	}
+	
+	auto laterRun = [&begins](size_t a, size_t b) { return *begins[a] > *begins[b]; };
+	
+	std::make_heap(heap.begin(), heap.end(), laterRun);
+	
+	while (!heap.empty())
+	{
+		size_t run = heap.front();
+		
+		*out++ = *begins[run]++;
+		
+		/* Replace the top with the same run (or the last run if it is used up) and sift it down once,
+		   instead of a pop and a push */
+		
+		if (begins[run] == ends[run])
+		{
+			heap.front() = heap.back();
+			heap.pop_back();
+		}
+		
+		size_t parent = 0;
+		size_t size = heap.size();
+		
+		while (true)
+		{
+			size_t child = 2 * parent + 1;
+			
+			if (child >= size)
+				break;
+			
+			if (child + 1 < size && laterRun(heap[child], heap[child + 1]))
+				child++;
+			
+			if (!laterRun(heap[parent], heap[child]))
+				break;
+			
+			std::swap(heap[parent], heap[child]);
+			parent = child;
+		}
+	}
+}
+
+
+void seqBlockMergeSort(int32_t* arr, size_t n, size_t tileSize, size_t mergeWays)
+{
+	if (n < 2)
+	{
+		return;
+	}
+	
+	tileSize = std::max<size_t>(tileSize, 1);
+	mergeWays = std::max<size_t>(mergeWays, 2);
+	
+	std::vector<int32_t> scratch(n);
+	std::vector<size_t> bounds;
+	
+	/* Sort each cache sized tile completely before moving to the next */
+	
+	for (size_t begin = 0; begin < n; begin += tileSize)
+	{
+		size_t length = std::min(tileSize, n - begin);
+		
+		sortTile(arr + begin, scratch.data() + begin, length);
+		
+		bounds.push_back(begin);
+	}
+	
+	bounds.push_back(n);
+	
+	/* Merge 'mergeWays' runs at a time, so the data crosses DRAM once per pass instead of once per level */
+	
+	int32_t* src = arr;
+	int32_t* dst = scratch.data();
+	
+	while (bounds.size() > 2)
+	{
+		std::vector<size_t> merged;
+		
+		for (size_t first = 0; first + 1 < bounds.size(); first += mergeWays)
+		{
+			size_t last = std::min(first + mergeWays, bounds.size() - 1);
+			
+			std::vector<const int32_t*> begins, ends;
+			
+			for (size_t r = first; r < last; r++)
+			{
+				begins.push_back(src + bounds[r]);
+				ends.push_back(src + bounds[r + 1]);
+			}
+			
+			multiwayMerge(begins, ends, dst + bounds[first]);
+			
+			merged.push_back(bounds[first]);
+		}
+		
+		merged.push_back(n);
+		
+		bounds = merged;
+		
+		std::swap(src, dst);
+	}
+	
+	if (src != arr)
+	{
+		std::copy(src, src + n, arr);
+	}
+}
+
+
+void seqBlockMergeSort(std::vector<int32_t>* arr, size_t tileSize, size_t mergeWays)
+{
+	if (arr == nullptr)
+	{
+		return;
+	}
+	
+	seqBlockMergeSort(arr->data(), arr->size(), tileSize, mergeWays);
+}
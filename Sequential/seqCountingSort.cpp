@@ -0,0 +1,33 @@
+/**
+*  seqCountingSort.cpp
+*
+*  Defines the sequential Counting Sort function, used for keys that span a small range
+*/
+
+#include "seqSorts.hpp"
+
+
+void seqCountingSort(std::vector<int32_t>* arr, int32_t min, int32_t max)
+{
+	if (arr == nullptr || arr->empty())
+	{
+		return;
+	}
+	
+	std::vector<size_t> counts((size_t)((int64_t)max - min) + 1);
+	
+	for (int32_t value : *arr)
+	{
+		counts[(int64_t)value - min]++;
+	}
+	
+	size_t k = 0;
+	
+	for (size_t key = 0; key < counts.size(); key++)
+	{
+		for (size_t c = 0; c < counts[key]; c++)
+		{
+			arr->at(k++) = (int32_t)(min + (int64_t)key);
+		}
+	}
+}
@@ -0,0 +1,124 @@
+/**
+*  seqInPlaceMergeSort.cpp
+*
+*  Defines the sequential in-place (low memory) Merge Sort function
+*/
+
+#include "seqSorts.hpp"
+#include "../CpuDispatch.hpp"
+
+#include <algorithm>
+
+
+const size_t IN_PLACE_RUN_SIZE = 32;
+
+
+// The splitting step of SymMerge (Kim and Kutzner) for the sorted ranges arr[a..m) and arr[m..b): finds
+// the section around 'm' whose two halves belong on the other side of the center with a binary search
+// on positions symmetric around it, and rotates it. Afterwards only arr[a..start) with arr[start..mid),
+// and arr[mid..end) with arr[end..b) are left to merge, and the two merges are independent
+//
+void symMergeRotate(int32_t* arr, size_t a, size_t m, size_t b, size_t* start, size_t* mid, size_t* end)
+{
+	*mid = a + (b - a) / 2;
+	
+	size_t n = *mid + m;
+	size_t low = (m > *mid) ? n - b : a;
+	size_t high = (m > *mid) ? *mid : m;
+	
+	size_t p = n - 1;
+	
+	while (low < high)
+	{
+		size_t c = low + (high - low) / 2;
+		
+		if (!(arr[p - c] < arr[c]))
+			low = c + 1;
+		else
+			high = c;
+	}
+	
+	*start = low;
+	*end = n - low;
+	
+	if (*start < m && m < *end)
+	{
+		std::rotate(arr + *start, arr + m, arr + *end);
+	}
+}
+
+
+// Merges the sorted ranges arr[a..m) and arr[m..b) in place with SymMerge. Uses no buffer and O(log n)
+// stack, at the cost of O(n log n) moves per merge instead of O(n)
+//
+void symMerge(int32_t* arr, size_t a, size_t m, size_t b)
+{
+	if (a >= m || m >= b)
+		return;
+	
+	/* A single value on either side is moved into place with one search and one rotation */
+	
+	if (m - a == 1)
+	{
+		int32_t* position = std::lower_bound(arr + m, arr + b, arr[a]);
+		
+		std::rotate(arr + a, arr + a + 1, position);
+		return;
+	}
+	
+	if (b - m == 1)
+	{
+		int32_t* position = std::upper_bound(arr + a, arr + m, arr[m]);
+		
+		std::rotate(position, arr + m, arr + b);
+		return;
+	}
+	
+	size_t start, mid, end;
+	
+	symMergeRotate(arr, a, m, b, &start, &mid, &end);
+	
+	symMerge(arr, a, start, mid);
+	symMerge(arr, mid, end, b);
+}
+
+
+// Sorts arr[begin..end) bottom-up without any extra memory: insertion sorted runs are merged in place
+//
+void inPlaceMergeSort(int32_t* arr, size_t begin, size_t end)
+{
+	for (size_t run = begin; run < end; run += IN_PLACE_RUN_SIZE)
+	{
+		smallSortKernel(arr + run, arr + std::min(run + IN_PLACE_RUN_SIZE, end));
+	}
+	
+	for (size_t width = IN_PLACE_RUN_SIZE; width < end - begin; width *= 2)
+	{
+		for (size_t left = begin; left + width < end; left += 2 * width)
+		{
+			symMerge(arr, left, left + width, std::min(left + 2 * width, end));
+		}
+	}
+}
+
+
+void seqInPlaceMergeSort(int32_t* arr, size_t n)
+{
+	if (n < 2)
+	{
+		return;
+	}
+	
+	inPlaceMergeSort(arr, 0, n);
+}
+
+
+void seqInPlaceMergeSort(std::vector<int32_t>* arr)
+{
+	if (arr == nullptr)
+	{
+		return;
+	}
+	
+	seqInPlaceMergeSort(arr->data(), arr->size());
+}
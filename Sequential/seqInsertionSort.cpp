@@ -12,10 +12,10 @@ void seqInsertionSort(std::vector<int32_t>* arr)
 	if (arr == nullptr || arr->size() < 2)
     return;
 
-  int n = arr->size();
-  for (int i = 1; i < n; ++i) {
-    int key = (*arr)[i];
-    int j = i - 1;
+  int64_t n = arr->size();
+  for (int64_t i = 1; i < n; ++i) {
+    int32_t key = (*arr)[i];
+    int64_t j = i - 1;
 
     while (j >= 0 && (*arr)[j] > key) {
       (*arr)[j + 1] = (*arr)[j];
@@ -5,55 +5,46 @@
 */
 
 #include "seqSorts.hpp"
+#include "../CpuDispatch.hpp"
 
-void merge(std::vector<int32_t>& arr, int left, int mid, int right){
-  int n1 = mid - left + 1;
-  int n2 = right - mid;
-
-  std::vector<int> L(n1), R(n2);
-
-  for (int i = 0; i < n1; ++i)
-    L[i] = arr[left + i];
-  for (int j = 0; j < n2; ++j)
-    R[j] = arr[mid + 1 + j];
-
-  int i = 0, j = 0, k = left;
-  while (i < n1 && j < n2) {
-    if (L[i] <= R[j]) {
-      arr[k] = L[i];
-      ++i;
-    } else {
-      arr[k] = R[j];
-      ++j;
-    }
-    ++k;
-  }
 
-  while (i < n1) {
-    arr[k] = L[i];
-    ++i;
-    ++k;
-  }
+// Ranges this short are insertion sorted instead of being split further
+const size_t MERGE_SORT_CUTOFF = 32;
 
-  while (j < n2) {
-    arr[k] = R[j];
-    ++j;
-    ++k;
-  }
+
+// Merges the sorted runs src[0..mid) and src[mid..n) into dst[0..n)
+//
+void merge(const int32_t* src, size_t mid, size_t n, int32_t* dst){
+  mergeKernel(src, mid, src + mid, n - mid, dst);
 }
 
-void mergeSort(std::vector<int32_t>& arr, int left, int right){
-  if (left < right){
-    int mid = left + (right - left) / 2;
-    mergeSort(arr, left, mid);
-    mergeSort(arr, mid + 1, right);
-    merge(arr, left, mid, right);
+// Sorts dst[0..n), where src[0..n) holds the same values and is used as the scratch space. The halves
+// are sorted into src (with the two buffers swapping roles) and merged back into dst, so each level
+// moves the data once with no copies or allocations
+//
+void mergeSort(int32_t* src, int32_t* dst, size_t n){
+  if (n <= MERGE_SORT_CUTOFF){
+    smallSortKernel(dst, dst + n);
+    return;
   }
+  size_t mid = n / 2;
+  mergeSort(dst, src, mid);
+  mergeSort(dst + mid, src + mid, n - mid);
+  merge(src, mid, n, dst);
+}
+
+void seqMergeSort(int32_t* arr, size_t n)
+{
+  if (n == 0)
+    return;
+  // One scratch buffer for the whole sort (large ones are placed on huge pages, see MemoryInfo.hpp)
+  std::vector<int32_t> scratch(arr, arr + n);
+  mergeSort(scratch.data(), arr, n);
 }
 
 void seqMergeSort(std::vector<int32_t>* arr)
 {
 	if (arr == nullptr || arr->empty())
     return;
-  mergeSort(*arr, 0, arr->size() - 1);
-}
\ No newline at end of file
+  seqMergeSort(arr->data(), arr->size());
+}
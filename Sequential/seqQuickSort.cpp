@@ -5,10 +5,13 @@
 */
 
 #include "seqSorts.hpp"
+#include "../CpuDispatch.hpp"
 #include <vector>
 
-int partition(std::vector<int32_t>& arr, int low, int high);
-void quickSort(std::vector<int32_t>& arr, int low, int high);
+int64_t partition(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void partition3(std::vector<int32_t>& arr, int64_t low, int64_t high, int64_t* lt, int64_t* gt);
+void medianOfThreeToHigh(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void quickSort(std::vector<int32_t>& arr, int64_t low, int64_t high);
 void seqQuickSort(std::vector<int32_t>* arr);
 
 void seqQuickSort(std::vector<int32_t>* arr)
@@ -21,35 +24,64 @@ void seqQuickSort(std::vector<int32_t>* arr)
 	quickSort(*arr,0, arr->size() - 1);
 }
 
-int partition(std::vector<int32_t>& arr, int low, int high)
+// Lomuto partition around arr[high], run by the kernel built for the current CPU path
+//
+int64_t partition(std::vector<int32_t>& arr, int64_t low, int64_t high)
 {
-	int32_t pivot = arr[high];
+	return low + (int64_t)partitionKernel(arr.data() + low, high - low + 1);
+}
 
-	int32_t i = low-1;
+// Three-way (Bentley-McIlroy) partition around arr[high]: keys equal to the pivot are swapped to both
+// ends while scanning, then into the middle. Afterwards arr[low..lt-1] < pivot, arr[lt..gt] == pivot and
+// arr[gt+1..high] > pivot, so runs of equal keys are finished in one pass instead of being sorted again.
+// Runs on the kernel built for the current CPU path
+//
+void partition3(std::vector<int32_t>& arr, int64_t low, int64_t high, int64_t* lt, int64_t* gt)
+{
+	size_t first, last;
 
-	for(int j = low; j <= high - 1; j++) 
-	{
-		if(arr[j] < pivot) 
-		{
-			i += 1;
-			std::swap(arr[i],arr[j]);
-		}
-	}
-	i += 1; 
-	std::swap(arr[i], arr[high]);
+	partition3Kernel(arr.data() + low, high - low + 1, &first, &last);
+
+	*lt = low + (int64_t)first;
+	*gt = low + (int64_t)last;
+}
+
+// Moves the median of arr[low], arr[mid] and arr[high] to arr[high], where the partitions take their
+// pivot from, so already sorted or reversed input does not degrade to quadratic time
+//
+void medianOfThreeToHigh(std::vector<int32_t>& arr, int64_t low, int64_t high)
+{
+	int64_t mid = low + (high - low) / 2;
 
-	return i;
+	if (arr[mid] < arr[low])
+		std::swap(arr[mid], arr[low]);
+	if (arr[high] < arr[low])
+		std::swap(arr[high], arr[low]);
+	if (arr[mid] < arr[high])
+		std::swap(arr[mid], arr[high]);
 }
 
-void quickSort(std::vector<int32_t>& arr, int low, int high)
+void quickSort(std::vector<int32_t>& arr, int64_t low, int64_t high)
 {
-	if(low >= high) 
+	/* Recurse into the smaller side and loop on the larger one, so the stack stays O(log n) deep */
+
+	while (low < high)
 	{
-		return;
-	}
+		int64_t lt, gt;
 
-	int p = partition(arr, low, high);
+		medianOfThreeToHigh(arr, low, high);
 
-	quickSort(arr, low, p-1);
-	quickSort(arr, p+1,  high);
+		partition3(arr, low, high, &lt, &gt);
+
+		if (lt - low < high - gt)
+		{
+			quickSort(arr, low, lt - 1);
+			low = gt + 1;
+		}
+		else
+		{
+			quickSort(arr, gt + 1, high);
+			high = lt - 1;
+		}
+	}
 }
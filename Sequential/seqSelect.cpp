@@ -0,0 +1,119 @@
+/**
+*  seqSelect.cpp
+*
+*  Defines the sequential top-k and nth element selection functions
+*/
+
+#include "seqSorts.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+
+const size_t HEAP_SELECT_MAX_K = 1024;
+
+
+// Reuse the partition, pivot and sorting functions from quick sort
+//
+int64_t partition(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void medianOfThreeToHigh(std::vector<int32_t>& arr, int64_t low, int64_t high);
+void quickSort(std::vector<int32_t>& arr, int64_t low, int64_t high);
+
+
+// Rearranges arr[low..high] so that arr[target] holds the value it would have after sorting
+//
+void quickSelect(std::vector<int32_t>& arr, int64_t low, int64_t high, int64_t target)
+{
+	/* Introselect: partition like quick sort but only follow the side holding 'target', and switch
+	   to the library's guaranteed linear selection if the pivots keep going badly */
+	
+	int depthLimit = 2 * (int)std::log2(high - low + 2);
+	
+	while (low < high)
+	{
+		if (depthLimit-- == 0)
+		{
+			std::nth_element(arr.begin() + low, arr.begin() + target, arr.begin() + high + 1);
+			return;
+		}
+		
+		medianOfThreeToHigh(arr, low, high);
+		
+		int64_t p = partition(arr, low, high);
+		
+		if (p == target)
+			return;
+		else if (target < p)
+			high = p - 1;
+		else
+			low = p + 1;
+	}
+}
+
+
+// Fills 'heap' with the k smallest values in [begin..end), as a max-heap
+//
+void heapSelect(const int32_t* begin, const int32_t* end, size_t k, std::vector<int32_t>* heap)
+{
+	heap->clear();
+	
+	if (k == 0)
+		return;
+	
+	for (const int32_t* value = begin; value != end; value++)
+	{
+		if (heap->size() < k)
+		{
+			heap->push_back(*value);
+			std::push_heap(heap->begin(), heap->end());
+		}
+		else if (*value < heap->front())
+		{
+			/* Replace the largest value kept so far */
+			
+			std::pop_heap(heap->begin(), heap->end());
+			heap->back() = *value;
+			std::push_heap(heap->begin(), heap->end());
+		}
+	}
+}
+
+
+int32_t seqNthElement(std::vector<int32_t>* arr, size_t n)
+{
+	quickSelect(*arr, 0, arr->size() - 1, n);
+	
+	return arr->at(n);
+}
+
+
+void seqTopK(std::vector<int32_t>* arr, size_t k)
+{
+	if (arr == nullptr)
+		return;
+	
+	k = std::min(k, arr->size());
+	
+	if (k <= HEAP_SELECT_MAX_K)
+	{
+		/* Small k: one pass over the data keeping a heap of k values */
+		
+		std::vector<int32_t> heap;
+		
+		heapSelect(arr->data(), arr->data() + arr->size(), k, &heap);
+		
+		std::sort_heap(heap.begin(), heap.end());
+		
+		arr->swap(heap);
+	}
+	else
+	{
+		/* Large k: move the k smallest to the front, then sort only those */
+		
+		quickSelect(*arr, 0, arr->size() - 1, k - 1);
+		
+		arr->resize(k);
+		
+		quickSort(*arr, 0, k - 1);
+	}
+}
@@ -10,11 +10,37 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 void seqBubbleSort(std::vector<int32_t>*);
 void seqInsertionSort(std::vector<int32_t>*);
 void seqMergeSort(std::vector<int32_t>*);
 void seqQuickSort(std::vector<int32_t>*);
 
+// In-place merge sort (SymMerge with rotations): no scratch buffers, O(n log^2 n) time
+//
+void seqInPlaceMergeSort(std::vector<int32_t>*);
+
+// Cache-blocked bottom-up merge sort: sorts tiles of 'tileSize' values, then merges 'mergeWays' runs at a time
+//
+void seqBlockMergeSort(std::vector<int32_t>*, size_t tileSize, size_t mergeWays);
+
+// The merge sorts on raw memory, for values that are not in a vector (ex. the shared memory of a service
+// request)
+//
+void seqMergeSort(int32_t*, size_t n);
+void seqInPlaceMergeSort(int32_t*, size_t n);
+void seqBlockMergeSort(int32_t*, size_t n, size_t tileSize, size_t mergeWays);
+
+// Counting sort for keys known to lie in [min..max], worthwhile when that range is small next to the size
+//
+void seqCountingSort(std::vector<int32_t>*, int32_t min, int32_t max);
+
+// Selection: after seqTopK() the vector holds only its k smallest values, sorted. seqNthElement()
+// returns the value at index n of the sorted order and leaves smaller values before it
+//
+void seqTopK(std::vector<int32_t>*, size_t k);
+int32_t seqNthElement(std::vector<int32_t>*, size_t n);
+
 
 #endif
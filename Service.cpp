@@ -0,0 +1,807 @@
+/**
+*  Service.cpp
+*
+*  Defines the sort service, a long running process that sorts the requests of other processes sent
+*  over a Unix domain socket, and the client side of its protocol
+*/
+
+#include "Service.hpp"
+#include "Distributed.hpp"
+#include "ThreadPool.hpp"
+#include "Stopwatch.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+
+typedef std::chrono::steady_clock ServiceClock;
+
+
+
+/*** Data Structures ***/
+
+// One sort request, owned by the connection that received it and waiting for it
+//
+struct ServiceJob
+{
+	SortParameters param;
+	size_t count{};
+	
+	int32_t* shared{};		// Mapped shared memory the values are sorted in, or nullptr to sort 'param.data'
+	
+	ServiceClock::time_point received;
+	ServiceClock::time_point started;
+	ServiceClock::time_point finished;
+	
+	bool done{};
+	std::mutex lock;
+	std::condition_variable doneSignal;
+};
+
+struct ServiceState
+{
+	int32_t numThreads{};
+	ThreadPool* pool{};
+	CoreBudget budget;						// Keeps parallel requests from running more threads than cores
+	
+	std::function<void(ServiceResult*)> logResult;
+	
+	ServiceClock::time_point startTime;
+	
+	std::mutex lock;						// Guards everything below
+	std::condition_variable batchReady;
+	std::condition_variable connectionClosed;
+	
+	std::vector<ServiceJob*> pendingTiny;	// Tiny requests waiting to be batched
+	size_t queued{};						// Requests waiting for a worker, batched or not
+	
+	bool stopping{};
+	std::vector<int> clients;				// Open connections
+	
+	uint64_t connections{};
+	uint64_t requests{};
+	uint64_t values{};
+	uint64_t batches{};
+	uint64_t batchedRequests{};
+	uint64_t errors{};
+	
+	std::vector<double> latencies;			// Ring of the most recent latencies, in seconds
+	size_t nextLatency{};
+};
+
+
+
+/*** Function Definitions ***/
+
+// Write end of the pipe that wakes the accept loop, for the signal handler
+//
+static std::atomic<int> wakeFd{ -1 };
+
+static void wakeService(int)
+{
+	int fd = wakeFd.load();
+	char byte = 1;
+	
+	if (fd >= 0)
+	{
+		ssize_t ignored = write(fd, &byte, 1);
+		(void)ignored;
+	}
+}
+
+
+static uint64_t toMicros(ServiceClock::duration d)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+
+// Sorts one request on the calling pool worker, then wakes its connection. A parallel request first
+// reserves its threads from the core budget, so the workers never run more threads than there are cores
+//
+static void runJob(ServiceState* state, ServiceJob* job)
+{
+	int32_t cores = (job->param.parallel) ? job->param.numThreads : 1;
+	
+	acquireCores(&(state->budget), cores);
+	
+	{
+		std::lock_guard<std::mutex> guard(state->lock);
+		
+		state->queued--;
+	}
+	
+	job->started = ServiceClock::now();
+	
+	if (job->shared == nullptr)
+	{
+		runSortingAlgorithm(&(job->param));
+	}
+	else if (!runSortingAlgorithm(&(job->param), job->shared, job->count))
+	{
+		/* Only the merge sorts take raw memory, the other algorithms sort a copy in the vector they take */
+		
+		job->param.data.assign(job->shared, job->shared + job->count);
+		
+		runSortingAlgorithm(&(job->param));
+		
+		std::copy(job->param.data.begin(), job->param.data.end(), job->shared);
+	}
+	
+	job->finished = ServiceClock::now();
+	
+	releaseCores(&(state->budget), cores);
+	
+	{
+		std::lock_guard<std::mutex> guard(state->lock);
+		
+		double latency = std::chrono::duration<double>(job->finished - job->received).count();
+		
+		if (state->latencies.size() < SERVICE_LATENCY_WINDOW)
+			state->latencies.push_back(latency);
+		else
+			state->latencies[state->nextLatency] = latency;
+		
+		state->nextLatency = (state->nextLatency + 1) % SERVICE_LATENCY_WINDOW;
+		
+		state->requests++;
+		state->values += job->count;
+	}
+	
+	/* Notified under the lock: the connection owns the job and may free it as soon as it sees 'done' */
+	
+	std::lock_guard<std::mutex> guard(job->lock);
+	
+	job->done = true;
+	job->doneSignal.notify_all();
+}
+
+
+// Queues a request: tiny ones for the batcher, the rest straight to the pool
+//
+static void submitJob(ServiceState* state, ServiceJob* job)
+{
+	std::lock_guard<std::mutex> guard(state->lock);
+	
+	state->queued++;
+	
+	if (job->count <= SERVICE_BATCH_CUTOFF)
+	{
+		state->pendingTiny.push_back(job);
+		state->batchReady.notify_one();
+	}
+	else
+	{
+		state->pool->submit([state, job](int32_t) { runJob(state, job); });
+	}
+}
+
+
+// Collects tiny requests into batches, so a burst of them costs one pool task instead of one each. While
+// there is an idle worker for every waiting request they go out at once, otherwise a batch goes out when
+// it is full or SERVICE_BATCH_WINDOW_US after its first request arrived
+//
+static void batcherLoop(ServiceState* state)
+{
+	std::unique_lock<std::mutex> guard(state->lock);
+	
+	while (true)
+	{
+		state->batchReady.wait(guard, [state] { return state->stopping || !state->pendingTiny.empty(); });
+		
+		if (state->pendingTiny.empty())
+		{
+			/* Only reached when stopping, after every tiny request has been handed out */
+			
+			return;
+		}
+		
+		/* Waiting for more requests only pays off when they would otherwise queue for a worker */
+		
+		if (state->queued > (size_t)state->pool->idle())
+		{
+			state->batchReady.wait_for(guard, std::chrono::microseconds(SERVICE_BATCH_WINDOW_US),
+			                           [state] { return state->stopping || state->pendingTiny.size() >= SERVICE_BATCH_MAX; });
+		}
+		
+		size_t count = std::min(state->pendingTiny.size(), SERVICE_BATCH_MAX);
+		
+		std::vector<ServiceJob*> batch(state->pendingTiny.begin(), state->pendingTiny.begin() + count);
+		
+		state->pendingTiny.erase(state->pendingTiny.begin(), state->pendingTiny.begin() + count);
+		
+		state->batches++;
+		state->batchedRequests += count;
+		
+		state->pool->submit([state, batch](int32_t)
+		{
+			for (ServiceJob* job : batch)
+			{
+				runJob(state, job);
+			}
+		});
+	}
+}
+
+
+// Gets the 'fraction' percentile of 'sorted', in milliseconds
+//
+static double getPercentile(std::vector<double>* sorted, double fraction)
+{
+	if (sorted->empty())
+		return 0.0;
+	
+	size_t index = std::min(sorted->size() - 1, (size_t)(fraction * sorted->size()));
+	
+	return sorted->at(index) * 1000.0;
+}
+
+
+static std::string getStatsJSON(ServiceState* state)
+{
+	std::lock_guard<std::mutex> guard(state->lock);
+	
+	std::vector<double> sorted = state->latencies;
+	
+	std::sort(sorted.begin(), sorted.end());
+	
+	std::stringstream json;
+	
+	json << std::setprecision(3) << std::fixed;
+	
+	json << "{"
+	     << "\"uptime\": " << std::chrono::duration<double>(ServiceClock::now() - state->startTime).count() << ", "
+	     << "\"workers\": " << state->pool->size() << ", "
+	     << "\"connections\": " << state->connections << ", "
+	     << "\"open_connections\": " << state->clients.size() << ", "
+	     << "\"requests\": " << state->requests << ", "
+	     << "\"values\": " << state->values << ", "
+	     << "\"batches\": " << state->batches << ", "
+	     << "\"batched_requests\": " << state->batchedRequests << ", "
+	     << "\"errors\": " << state->errors << ", "
+	     << "\"queue_depth\": " << state->queued << ", "
+	     << "\"latency_samples\": " << sorted.size() << ", "
+	     << "\"latency_ms\": {"
+	     << "\"p50\": " << getPercentile(&sorted, 0.50) << ", "
+	     << "\"p90\": " << getPercentile(&sorted, 0.90) << ", "
+	     << "\"p99\": " << getPercentile(&sorted, 0.99) << ", "
+	     << "\"max\": " << ((sorted.empty()) ? 0.0 : sorted.back() * 1000.0) << "}}";
+	
+	return json.str();
+}
+
+
+static bool sendResponse(int fd, ServiceResponseHeader* response, const void* payload)
+{
+	return sendAll(fd, response, sizeof(*response)) && (response->length == 0 || sendAll(fd, payload, response->length));
+}
+
+
+// Answers a request that cannot be served. The connection is closed afterwards, since the rest of the
+// request may still be on the socket
+//
+static bool rejectRequest(ServiceState* state, int fd, ServiceStatus status)
+{
+	{
+		std::lock_guard<std::mutex> guard(state->lock);
+		
+		state->errors++;
+	}
+	
+	ServiceResponseHeader response;
+	response.status = status;
+	
+	sendResponse(fd, &response, nullptr);
+	
+	return false;
+}
+
+
+// Receives, sorts and answers one sort request. Returns false if the connection should be closed
+//
+static bool serveSortRequest(ServiceState* state, int fd, ServiceRequestHeader* request)
+{
+	if (request->count > SERVICE_MAX_VALUES)
+		return rejectRequest(state, fd, ServiceStatus::TooLarge);
+	else if (request->algorithm > (uint8_t)SortAlgorithm::BlockMerge)
+		return rejectRequest(state, fd, ServiceStatus::BadRequest);
+	else if (request->count == 0)
+	{
+		ServiceResponseHeader response;
+		
+		return sendResponse(fd, &response, nullptr);
+	}
+	
+	ServiceJob job;
+	
+	job.received = ServiceClock::now();
+	job.count = request->count;
+	
+	bool sharedMemory = (request->payload == ServicePayload::SharedMemory);
+	
+	/* Left to the service, shared memory requests get merge sort, which sorts the mapped values where
+	   they lie instead of copying them into a vector and back */
+	
+	job.param.algorithm = (SortAlgorithm)request->algorithm;
+	
+	if (job.param.algorithm == SortAlgorithm::None)
+		job.param.algorithm = (sharedMemory) ? SortAlgorithm::Merge : SortAlgorithm::Quick;
+	
+	job.param.parallel = (request->count >= SERVICE_PARALLEL_CUTOFF);
+	job.param.numThreads = state->numThreads;
+	
+	size_t bytes = request->count * sizeof(int32_t);
+	
+	if (sharedMemory)
+	{
+		/* Nothing goes through the socket, the values are sorted in the mapping (see runJob) */
+		
+		request->shmName[sizeof(request->shmName) - 1] = '\0';
+		
+		int shm = shm_open(request->shmName, O_RDWR, 0);
+		struct stat info;
+		
+		if (shm >= 0 && fstat(shm, &info) == 0 && (size_t)info.st_size >= bytes)
+		{
+			void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+			
+			job.shared = (memory == MAP_FAILED) ? nullptr : (int32_t*)memory;
+		}
+		
+		if (shm >= 0)
+			close(shm);
+		
+		if (job.shared == nullptr)
+			return rejectRequest(state, fd, ServiceStatus::SharedMemoryFailed);
+	}
+	else
+	{
+		job.param.data.resize(request->count);
+		
+		if (!recvAll(fd, job.param.data.data(), bytes))
+			return false;
+	}
+	
+	submitJob(state, &job);
+	
+	{
+		std::unique_lock<std::mutex> guard(job.lock);
+		
+		job.doneSignal.wait(guard, [&job] { return job.done; });
+	}
+	
+	ServiceResponseHeader response;
+	
+	response.queueMicros = toMicros(job.started - job.received);
+	response.sortMicros = toMicros(job.finished - job.started);
+	
+	bool sent;
+	
+	if (job.shared != nullptr)
+	{
+		munmap(job.shared, bytes);
+		
+		sent = sendResponse(fd, &response, nullptr);
+	}
+	else
+	{
+		response.length = bytes;
+		
+		sent = sendResponse(fd, &response, job.param.data.data());
+	}
+	
+	/* Logged after answering, so the results log never adds to the latency the client sees */
+	
+	if (state->logResult)
+	{
+		ServiceResult result;
+		
+		result.algorithm = job.param.algorithm;
+		result.parallel = job.param.parallel;
+		result.numThreads = (job.param.parallel) ? job.param.numThreads : 1;
+		result.dataLength = job.count;
+		result.sortTime = std::chrono::duration<double>(job.finished - job.started).count();
+		result.queueTime = std::chrono::duration<double>(job.started - job.received).count();
+		
+		state->logResult(&result);
+	}
+	
+	return sent;
+}
+
+
+// Serves the requests of one client until it disconnects
+//
+static void handleConnection(ServiceState* state, int fd)
+{
+	ServiceRequestHeader request;
+	bool open = true;
+	
+	while (open && recvAll(fd, &request, sizeof(request)))
+	{
+		if (request.magic != SERVICE_REQUEST_MAGIC)
+		{
+			open = rejectRequest(state, fd, ServiceStatus::BadRequest);
+		}
+		else if (request.type == ServiceRequestType::Stats)
+		{
+			std::string stats = getStatsJSON(state);
+			
+			ServiceResponseHeader response;
+			response.length = stats.size();
+			
+			open = sendResponse(fd, &response, stats.data());
+		}
+		else if (request.type == ServiceRequestType::Shutdown)
+		{
+			ServiceResponseHeader response;
+			
+			open = sendResponse(fd, &response, nullptr);
+			
+			wakeService(0);
+		}
+		else if (request.type == ServiceRequestType::Sort)
+		{
+			bool stopping;
+			
+			{
+				std::lock_guard<std::mutex> guard(state->lock);
+				
+				stopping = state->stopping;
+			}
+			
+			if (stopping)
+				open = rejectRequest(state, fd, ServiceStatus::ShuttingDown);
+			else
+				open = serveSortRequest(state, fd, &request);
+		}
+		else
+		{
+			open = rejectRequest(state, fd, ServiceStatus::BadRequest);
+		}
+	}
+	
+	std::lock_guard<std::mutex> guard(state->lock);
+	
+	state->clients.erase(std::find(state->clients.begin(), state->clients.end(), fd));
+	
+	close(fd);
+	
+	state->connectionClosed.notify_all();
+}
+
+
+// Fills 'address' with 'socketPath'. Returns false if the path is too long for a socket address
+//
+static bool makeSocketAddress(std::string socketPath, sockaddr_un* address, std::string* error)
+{
+	std::memset(address, 0, sizeof(*address));
+	address->sun_family = AF_UNIX;
+	
+	if (socketPath.empty() || socketPath.size() >= sizeof(address->sun_path))
+	{
+		*error = "Invalid socket path \"" + socketPath + "\"";
+		return false;
+	}
+	
+	std::strcpy(address->sun_path, socketPath.c_str());
+	
+	return true;
+}
+
+
+bool runSortService(std::string socketPath, int32_t numWorkers, int32_t numThreads, std::function<void(ServiceResult*)> logResult, std::string* error)
+{
+	sockaddr_un address;
+	
+	if (!makeSocketAddress(socketPath, &address, error))
+		return false;
+	
+	/* A socket left behind by a service that did not stop cleanly is replaced, anything else is not */
+	
+	struct stat existing;
+	
+	if (lstat(socketPath.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+	{
+		unlink(socketPath.c_str());
+	}
+	
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	
+	if (listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0)
+	{
+		*error = "Cannot listen on \"" + socketPath + "\" (" + std::strerror(errno) + ")";
+		
+		if (listener >= 0)
+			close(listener);
+		
+		return false;
+	}
+	
+	int wakePipe[2];
+	
+	if (pipe(wakePipe) != 0)
+	{
+		close(listener);
+		unlink(socketPath.c_str());
+		
+		*error = "Cannot create a pipe";
+		return false;
+	}
+	
+	wakeFd = wakePipe[1];
+	
+	signal(SIGINT, wakeService);
+	signal(SIGTERM, wakeService);
+	signal(SIGPIPE, SIG_IGN);
+	
+	ThreadPool pool(numWorkers);
+	
+	ServiceState state;
+	
+	state.numThreads = std::min(numThreads, std::max(numWorkers, 1));
+	state.pool = &pool;
+	state.budget.available = std::max(numWorkers, 1);
+	state.logResult = logResult;
+	state.startTime = ServiceClock::now();
+	
+	std::thread batcher(batcherLoop, &state);
+	
+	
+	/* Accept connections until woken by a shutdown request or a signal */
+	
+	pollfd fds[2] = { { listener, POLLIN, 0 }, { wakePipe[0], POLLIN, 0 } };
+	
+	while (true)
+	{
+		if (poll(fds, 2, -1) < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			
+			break;
+		}
+		
+		if (fds[1].revents != 0)
+			break;
+		
+		if (fds[0].revents & POLLIN)
+		{
+			int client = accept(listener, nullptr, nullptr);
+			
+			if (client < 0)
+				continue;
+			
+			std::lock_guard<std::mutex> guard(state.lock);
+			
+			state.clients.push_back(client);
+			state.connections++;
+			
+			std::thread(handleConnection, &state, client).detach();
+		}
+	}
+	
+	
+	/* Stop: no new connections or requests, let the ones being sorted finish, then stop the workers */
+	
+	close(listener);
+	unlink(socketPath.c_str());
+	
+	{
+		std::unique_lock<std::mutex> guard(state.lock);
+		
+		state.stopping = true;
+		
+		for (int client : state.clients)
+		{
+			shutdown(client, SHUT_RD);
+		}
+		
+		state.batchReady.notify_all();
+		
+		state.connectionClosed.wait(guard, [&state] { return state.clients.empty(); });
+	}
+	
+	batcher.join();
+	
+	pool.wait();
+	
+	wakeFd = -1;
+	
+	close(wakePipe[0]);
+	close(wakePipe[1]);
+	
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	
+	std::cout << "\n " << getStatsJSON(&state) << "\n";
+	
+	return true;
+}
+
+
+// Connects to the service on 'socketPath'. Returns -1 and sets 'error' if it fails
+//
+static int connectToService(std::string socketPath, std::string* error)
+{
+	sockaddr_un address;
+	
+	if (!makeSocketAddress(socketPath, &address, error))
+		return -1;
+	
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	
+	if (fd < 0 || connect(fd, (sockaddr*)&address, sizeof(address)) != 0)
+	{
+		*error = "Cannot connect to \"" + socketPath + "\" (" + std::strerror(errno) + ")";
+		
+		if (fd >= 0)
+			close(fd);
+		
+		return -1;
+	}
+	
+	return fd;
+}
+
+
+// Sends 'request' (and 'payload') and receives the response header. Returns false and sets 'error' if
+// the exchange fails or the service did not answer Ok
+//
+static bool exchange(int fd, ServiceRequestHeader* request, const void* payload, size_t payloadSize, ServiceResponseHeader* response, std::string* error)
+{
+	if (!sendAll(fd, request, sizeof(*request)) || (payloadSize > 0 && !sendAll(fd, payload, payloadSize)) ||
+	    !recvAll(fd, response, sizeof(*response)) || response->magic != SERVICE_RESPONSE_MAGIC)
+	{
+		*error = "Connection to the sort service failed";
+		return false;
+	}
+	
+	if (response->status != ServiceStatus::Ok)
+	{
+		*error = "Sort service rejected the request (status " + std::to_string((int32_t)response->status) + ")";
+		return false;
+	}
+	
+	return true;
+}
+
+
+bool requestSort(std::string socketPath, std::vector<int32_t>* data, SortAlgorithm algorithm, bool sharedMemory, ServiceTiming* timing, std::string* error)
+{
+	static std::atomic<uint32_t> nextObject{ 0 };
+	
+	Stopwatch timer;
+	timer.start();
+	
+	int fd = connectToService(socketPath, error);
+	
+	if (fd < 0)
+		return false;
+	
+	ServiceRequestHeader request;
+	ServiceResponseHeader response;
+	
+	request.algorithm = (uint8_t)algorithm;
+	request.count = data->size();
+	
+	size_t bytes = data->size() * sizeof(int32_t);
+	bool succeeded = false;
+	
+	if (sharedMemory && bytes > 0)
+	{
+		request.payload = ServicePayload::SharedMemory;
+		
+		snprintf(request.shmName, sizeof(request.shmName), "/sorttest_%d_%u", (int)getpid(), nextObject++);
+		
+		int shm = shm_open(request.shmName, O_CREAT | O_EXCL | O_RDWR, 0600);
+		void* memory = MAP_FAILED;
+		
+		if (shm >= 0 && ftruncate(shm, bytes) == 0)
+		{
+			memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+		}
+		
+		if (memory != MAP_FAILED)
+		{
+			std::copy(data->begin(), data->end(), (int32_t*)memory);
+			
+			succeeded = exchange(fd, &request, nullptr, 0, &response, error);
+			
+			if (succeeded)
+				std::copy((int32_t*)memory, (int32_t*)memory + data->size(), data->begin());
+			
+			munmap(memory, bytes);
+		}
+		else
+		{
+			*error = "Cannot create shared memory for the request";
+		}
+		
+		if (shm >= 0)
+		{
+			close(shm);
+			shm_unlink(request.shmName);
+		}
+	}
+	else
+	{
+		succeeded = exchange(fd, &request, data->data(), bytes, &response, error) && response.length == bytes &&
+		            recvAll(fd, data->data(), bytes);
+		
+		if (!succeeded && error->empty())
+			*error = "Sort service sent an incomplete response";
+	}
+	
+	close(fd);
+	
+	timer.stop();
+	
+	timing->roundTrip = timer.getSeconds();
+	timing->queue = response.queueMicros / 1e6;
+	timing->sort = response.sortMicros / 1e6;
+	
+	return succeeded;
+}
+
+
+bool requestStats(std::string socketPath, std::string* stats, std::string* error)
+{
+	int fd = connectToService(socketPath, error);
+	
+	if (fd < 0)
+		return false;
+	
+	ServiceRequestHeader request;
+	ServiceResponseHeader response;
+	
+	request.type = ServiceRequestType::Stats;
+	
+	bool succeeded = exchange(fd, &request, nullptr, 0, &response, error);
+	
+	if (succeeded)
+	{
+		stats->resize(response.length);
+		
+		succeeded = recvAll(fd, &((*stats)[0]), response.length);
+	}
+	
+	close(fd);
+	
+	return succeeded;
+}
+
+
+bool requestShutdown(std::string socketPath, std::string* error)
+{
+	int fd = connectToService(socketPath, error);
+	
+	if (fd < 0)
+		return false;
+	
+	ServiceRequestHeader request;
+	ServiceResponseHeader response;
+	
+	request.type = ServiceRequestType::Shutdown;
+	
+	bool succeeded = exchange(fd, &request, nullptr, 0, &response, error);
+	
+	close(fd);
+	
+	return succeeded;
+}
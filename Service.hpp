@@ -0,0 +1,133 @@
+/**
+*  Service.hpp
+*
+*  Declares the sort service, a long running process that sorts the requests of other processes sent
+*  over a Unix domain socket, and the client side of its protocol
+*/
+
+#ifndef SERVICE_HPP_MULTITHREADED_SORTING
+#define SERVICE_HPP_MULTITHREADED_SORTING
+
+
+#include "SortRunner.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+
+
+/*** Constants ***/
+
+const uint32_t SERVICE_REQUEST_MAGIC = 0x51545253;		// "SRTQ"
+const uint32_t SERVICE_RESPONSE_MAGIC = 0x52545253;		// "SRTR"
+
+const uint64_t SERVICE_MAX_VALUES = (uint64_t)1 << 28;	// Largest request, 1 GB of values
+
+const size_t SERVICE_BATCH_CUTOFF = 1 << 12;		// Requests up to this many values are batched together
+const size_t SERVICE_BATCH_MAX = 64;				// Most requests sorted by one pool task
+const int32_t SERVICE_BATCH_WINDOW_US = 200;		// Longest a tiny request waits for others to join its batch
+
+const size_t SERVICE_PARALLEL_CUTOFF = 1 << 20;		// Requests this large are sorted with the parallel version
+
+const size_t SERVICE_LATENCY_WINDOW = 1 << 14;		// Latencies kept for the percentiles (the most recent ones)
+
+
+
+/*** Data Structures ***/
+
+enum class ServiceRequestType : uint8_t
+{
+	Sort = 1,
+	Stats,			// Returns the service statistics as a JSON object
+	Shutdown
+};
+
+enum class ServicePayload : uint8_t
+{
+	Inline = 0,		// The values follow the header on the socket and are sent back the same way
+	SharedMemory	// The values are in the POSIX shared memory object 'shmName' and are sorted in place
+};
+
+enum class ServiceStatus : int32_t
+{
+	Ok = 0,
+	BadRequest,
+	TooLarge,
+	SharedMemoryFailed,
+	ShuttingDown
+};
+
+// Fixed size request header (native byte order, both sides run on the same machine)
+//
+struct ServiceRequestHeader
+{
+	uint32_t magic = SERVICE_REQUEST_MAGIC;
+	ServiceRequestType type = ServiceRequestType::Sort;
+	uint8_t algorithm{};				// A SortAlgorithm, None lets the service choose (quick sort)
+	ServicePayload payload = ServicePayload::Inline;
+	uint8_t reserved{};
+	uint64_t count{};					// Number of int32_t values
+	char shmName[64]{};
+};
+
+// Fixed size response header, followed by 'length' bytes: the sorted values or the statistics text
+//
+struct ServiceResponseHeader
+{
+	uint32_t magic = SERVICE_RESPONSE_MAGIC;
+	ServiceStatus status = ServiceStatus::Ok;
+	uint64_t length{};
+	uint64_t queueMicros{};		// Time from receiving the request to a worker starting on it
+	uint64_t sortMicros{};		// Time the worker took to sort it
+};
+
+// One request the service sorted, as passed to its results callback
+//
+struct ServiceResult
+{
+	SortAlgorithm algorithm{};
+	bool parallel{};
+	int32_t numThreads{};
+	size_t dataLength{};
+	double sortTime{};		// In seconds
+	double queueTime{};		// Waiting for a worker, in seconds
+};
+
+struct ServiceTiming
+{
+	double roundTrip{};		// As seen by the client, in seconds
+	double queue{};			// Reported by the service, in seconds
+	double sort{};
+};
+
+
+
+/*** Function Declarations ***/
+
+// Listens on 'socketPath' and sorts the requests that arrive until a shutdown request, SIGINT or SIGTERM.
+// Requests are sorted on a pool of 'numWorkers' threads with runSortingAlgorithm(). Tiny requests are
+// batched into one pool task, and requests of SERVICE_PARALLEL_CUTOFF values or more use the parallel
+// version with 'numThreads' threads (at most 'numWorkers'). The workers share a budget of 'numWorkers'
+// cores, so a parallel request waits until its threads are free instead of oversubscribing the machine.
+// 'logResult' is called for every sorted request once it has been answered, on the thread of its
+// connection. Returns false and sets 'error' if the socket cannot be opened
+//
+bool runSortService(std::string socketPath, int32_t numWorkers, int32_t numThreads, std::function<void(ServiceResult*)> logResult, std::string* error);
+
+// Sends 'data' to the service to be sorted with 'algorithm' (None lets the service choose) and replaces it
+// with the result. With 'sharedMemory' the values go through a shared memory object instead of the socket.
+// Returns false and sets 'error' if it fails
+//
+bool requestSort(std::string socketPath, std::vector<int32_t>* data, SortAlgorithm algorithm, bool sharedMemory, ServiceTiming* timing, std::string* error);
+
+// Gets the service statistics (request counts, latency percentiles, queue depth) as a JSON object
+//
+bool requestStats(std::string socketPath, std::string* stats, std::string* error);
+
+// Asks the service to finish the requests it has and stop
+//
+bool requestShutdown(std::string socketPath, std::string* error);
+
+
+#endif
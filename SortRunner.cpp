@@ -0,0 +1,377 @@
+/**
+*  SortRunner.cpp
+*
+*  Defines the functions that load, sort and check test data
+*/
+
+#include "SortRunner.hpp"
+#include "Sequential/seqSorts.hpp"
+#include "Parallel/parSorts.hpp"
+#include "CacheInfo.hpp"
+#include "CpuDispatch.hpp"
+
+#include <iostream>
+#include <stdlib.h>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <filesystem>
+
+
+const size_t LOAD_BLOCK_SIZE = 1 << 20;	// Bytes read and parsed at a time by readTestData()
+const size_t MIN_LOAD_BLOCK_SIZE = 4096;
+
+
+SortAlgorithm parseAlgorithmName(std::string name)
+{
+	if (name == "bubble")
+		return SortAlgorithm::Bubble;
+	else if (name == "insertion")
+		return SortAlgorithm::Insertion;
+	else if (name == "merge")
+		return SortAlgorithm::Merge;
+	else if (name == "quick")
+		return SortAlgorithm::Quick;
+	else if (name == "blockmerge")
+		return SortAlgorithm::BlockMerge;
+	
+	return SortAlgorithm::None;
+}
+
+
+std::string getAlgorithmKey(SortAlgorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case SortAlgorithm::Bubble:
+		
+		return "bubble";
+	
+	case SortAlgorithm::Insertion:
+		
+		return "insertion";
+	
+	case SortAlgorithm::Merge:
+		
+		return "merge";
+	
+	case SortAlgorithm::Quick:
+		
+		return "quick";
+	
+	case SortAlgorithm::BlockMerge:
+		
+		return "blockmerge";
+	}
+	
+	return "none";
+}
+
+
+std::string getAlgorithmName(SortAlgorithm algorithm)
+{
+	switch (algorithm)
+	{
+	case SortAlgorithm::Bubble:
+		
+		return "Bubble Sort";
+	
+	case SortAlgorithm::Insertion:
+		
+		return "Insertion Sort";
+	
+	case SortAlgorithm::Merge:
+		
+		return "Merge Sort";
+	
+	case SortAlgorithm::Quick:
+		
+		return "Quick Sort";
+	
+	case SortAlgorithm::BlockMerge:
+		
+		return "Cache-Blocked Merge Sort";
+	}
+	
+	return "None";
+}
+
+
+bool readNumberBlocks(FILE* input, size_t blockSize, std::function<bool(const char* text, size_t length)> parse)
+{
+	std::vector<char> block(std::max<size_t>(blockSize, 1));
+	size_t carried = 0;		// Bytes of a number cut off at the end of the previous block
+	
+	while (true)
+	{
+		size_t read = fread(block.data() + carried, 1, block.size() - carried, input);
+		size_t bytes = carried + read;
+		
+		if (read == 0)
+		{
+			/* A failed read ends the input early, so the carried bytes may not be a whole number */
+			
+			if (ferror(input))
+				return false;
+			
+			/* The last number may end the input without whitespace after it */
+			
+			return parse(block.data(), carried);
+		}
+		
+		/* Parse up to the last whitespace, the number after it may continue in the next block */
+		
+		size_t end = bytes;
+		
+		while (end > 0 && !std::isspace((unsigned char)block[end - 1]))
+			end--;
+		
+		if (end == 0 && bytes == block.size())
+			return false;
+		
+		if (!parse(block.data(), end))
+			return false;
+		
+		carried = bytes - end;
+		
+		std::memmove(block.data(), block.data() + end, carried);
+	}
+}
+
+
+bool readTestData(std::string fileName, std::vector<int32_t>* buffer, std::string* error)
+{
+	FILE* dataFile = fopen(fileName.c_str(), "rb");
+	
+	if (dataFile == nullptr)
+	{
+		*error = "Cannot open file \"" + fileName + "\"";
+		
+		return false;
+	}
+	
+	/* Small files only get a block as large as they are, so loading many of them stays cheap */
+	
+	std::error_code ec;
+	size_t fileSize = std::filesystem::file_size(fileName, ec);
+	size_t blockSize = (ec) ? LOAD_BLOCK_SIZE : std::clamp<size_t>(fileSize + 1, MIN_LOAD_BLOCK_SIZE, LOAD_BLOCK_SIZE);
+	
+	bool parsed = readNumberBlocks(dataFile, blockSize, [buffer](const char* text, size_t length)
+	{
+		return parseIntegersKernel(text, length, buffer);
+	});
+	
+	fclose(dataFile);
+	
+	if (!parsed)
+	{
+		*error = "Failure occured while reading from \"" + fileName + "\"";
+		
+		return false;
+	}
+	
+	return true;
+}
+
+
+void loadTestData(std::string fileName, std::vector<int32_t>* buffer)
+{
+	std::string error;
+	
+	if (!readTestData(fileName, buffer, &error))
+	{
+		std::cout << "\n   ERROR: " << error << "\n\n";
+		
+		exit(2);
+	}
+}
+
+
+// Sorts 'param->data' with counting sort if its key range is small enough that counting every possible
+// key (once per thread) costs no more than a pass over the data. Returns false if it was not used
+//
+static bool tryCountingSort(SortParameters* param)
+{
+	param->countingRange = 0;
+	
+	if (!param->countingSort || param->data.empty())
+	{
+		return false;
+	}
+	
+	int32_t numThreads = (param->parallel) ? param->numThreads : 1;
+	int32_t min, max;
+	
+	if (param->parallel)
+	{
+		parMinMax(&(param->data), numThreads, &min, &max);
+	}
+	else
+	{
+		auto minMax = std::minmax_element(param->data.begin(), param->data.end());
+		
+		min = *minMax.first;
+		max = *minMax.second;
+	}
+	
+	int64_t range = (int64_t)max - min + 1;
+	
+	if (range > COUNTING_SORT_MAX_RANGE || range * numThreads > (int64_t)param->data.size())
+	{
+		return false;
+	}
+	
+	if (param->parallel)
+		parCountingSort(&(param->data), min, max, numThreads);
+	else
+		seqCountingSort(&(param->data), min, max);
+	
+	param->countingRange = range;
+	
+	return true;
+}
+
+
+// Fills in the block merge tile size and merge ways that were not given, from the cache sizes
+//
+static void setBlockSizes(SortParameters* param)
+{
+	CacheInfo cache = getCacheInfo();
+	
+	if (param->tileSize == 0)
+		param->tileSize = getDefaultTileSize(&cache);
+	if (param->mergeWays == 0)
+		param->mergeWays = getDefaultMergeWays(&cache);
+}
+
+
+void runSortingAlgorithm(SortParameters* param)
+{
+	if (param->selection == SelectionMode::TopK)
+	{
+		if (param->parallel)
+			parTopK(&(param->data), param->selectRank, param->numThreads);
+		else
+			seqTopK(&(param->data), param->selectRank);
+		return;
+	}
+	else if (param->selection == SelectionMode::Nth)
+	{
+		if (param->parallel)
+			param->selectedValue = parNthElement(&(param->data), param->selectRank, param->numThreads);
+		else
+			param->selectedValue = seqNthElement(&(param->data), param->selectRank);
+		return;
+	}
+	
+	switch (param->algorithm)
+	{
+	case SortAlgorithm::Bubble:
+		
+		if (param->parallel)
+			parBubbleSort(&(param->data), param->numThreads);
+		else
+			seqBubbleSort(&(param->data));
+		break;
+	
+	case SortAlgorithm::Insertion:
+		
+		if (param->parallel)
+			parInsertionSort(&(param->data), param->numThreads);
+		else
+			seqInsertionSort(&(param->data));
+		break;
+	
+	case SortAlgorithm::Merge:
+		
+		if (param->lowMemory)
+		{
+			if (param->parallel)
+				parInPlaceMergeSort(&(param->data), param->numThreads);
+			else
+				seqInPlaceMergeSort(&(param->data));
+		}
+		else if (param->parallel)
+			parMergeSort(&(param->data), param->numThreads);
+		else
+			seqMergeSort(&(param->data));
+		break;
+	
+	case SortAlgorithm::Quick:
+		
+		if (tryCountingSort(param))
+			break;
+		
+		if (param->parallel)
+			parQuickSort(&(param->data), param->numThreads);
+		else
+			seqQuickSort(&(param->data));
+		break;
+	
+	case SortAlgorithm::BlockMerge:
+		
+		setBlockSizes(param);
+		
+		if (param->parallel)
+			parBlockMergeSort(&(param->data), param->tileSize, param->mergeWays, param->numThreads);
+		else
+			seqBlockMergeSort(&(param->data), param->tileSize, param->mergeWays);
+		break;
+	}
+}
+
+
+bool runSortingAlgorithm(SortParameters* param, int32_t* data, size_t n)
+{
+	if (param->selection != SelectionMode::None)
+	{
+		return false;
+	}
+	
+	switch (param->algorithm)
+	{
+	case SortAlgorithm::Merge:
+		
+		if (param->lowMemory)
+		{
+			if (param->parallel)
+				parInPlaceMergeSort(data, n, param->numThreads);
+			else
+				seqInPlaceMergeSort(data, n);
+		}
+		else if (param->parallel)
+			parMergeSort(data, n, param->numThreads);
+		else
+			seqMergeSort(data, n);
+		return true;
+	
+	case SortAlgorithm::BlockMerge:
+		
+		setBlockSizes(param);
+		
+		if (param->parallel)
+			parBlockMergeSort(data, n, param->tileSize, param->mergeWays, param->numThreads);
+		else
+			seqBlockMergeSort(data, n, param->tileSize, param->mergeWays);
+		return true;
+	
+	default:
+		
+		return false;
+	}
+}
+
+
+bool isSorted(std::vector<int32_t>* buffer)
+{
+	for (size_t i = 1; i < buffer->size(); i++)
+	{
+		if (buffer->at(i - 1) > buffer->at(i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
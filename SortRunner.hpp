@@ -0,0 +1,158 @@
+/**
+*  SortRunner.hpp
+*
+*  Declares the shared sort parameters and the functions that load, sort and check test data
+*/
+
+#ifndef SORT_RUNNER_HPP_MULTITHREADED_SORTING
+#define SORT_RUNNER_HPP_MULTITHREADED_SORTING
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+#include "Records/recordSorts.hpp"
+
+
+/*** Constants ***/
+
+const int32_t MIN_NUM_THREADS = 2;
+const int32_t MAX_NUM_THREADS = 100;
+const int32_t DEFAULT_NUM_THREADS = 4;
+
+const int32_t DEFAULT_CHUNK_SIZE = 1 << 20;
+
+const int32_t COUNTING_SORT_MAX_RANGE = 1 << 22;	// Largest key range (max - min + 1) given to counting sort
+
+const int32_t MIN_RECORD_SIZE = 4;
+const int32_t MAX_RECORD_SIZE = 1024;
+
+
+
+/*** Data Structures ***/
+
+enum class SortAlgorithm
+{
+	None,
+	Bubble,
+	Insertion,
+	Merge,
+	Quick,
+	BlockMerge	// Cache-blocked bottom-up merge sort
+};
+
+enum class SelectionMode
+{
+	None,
+	TopK,	// Keep only the k smallest values, sorted
+	Nth		// Find the value at index n of the sorted order
+};
+
+struct SortParameters
+{
+	std::string dataFile = "";
+	SortAlgorithm algorithm{};
+	int32_t numThreads = DEFAULT_NUM_THREADS;
+	bool parallel{};
+	bool verify{};
+	bool sweep{};
+	bool stream{};
+	size_t chunkSize = DEFAULT_CHUNK_SIZE;	// Values per chunk in streaming mode
+	
+	bool countingSort = true;	// Let quick sort switch to counting sort when the key range is small
+	size_t countingRange{};		// Key range counting sort was used for, 0 if it was not
+	
+	bool lowMemory{};			// Merge sort in place instead of through scratch buffers
+	
+	size_t tileSize{};			// Block merge tile size in values, 0 sizes it from the L2 cache
+	size_t mergeWays{};			// Runs merged at once by block merge, 0 sizes it from the L2 cache
+	
+	SelectionMode selection = SelectionMode::None;
+	size_t selectRank{};		// k for top-k, n for nth element
+	int32_t selectedValue{};	// Result of the nth element selection
+	
+	size_t recordSize{};	// 0 sorts plain integers
+	RecordLayout recordLayout = RecordLayout::ArrayOfStructs;
+	RecordEngine recordEngine = RecordEngine::Merge;
+	size_t columnWidth = 8;
+	
+	int32_t argsortBits{};			// 0 sorts the data itself, 32 or 64 saves the sorted order as indices of that width
+	std::string gatherTime = "";	// Time taken to apply the argsort order to the keys, for the report
+	double gatherSeconds{};			// Same, in seconds, for the results log
+	
+	bool strings{};			// Sort the lines of the data file as byte strings instead of integers
+	size_t stringBytes{};	// Size of the line arena, for the report
+	
+	std::string resultsLog = "results.jsonl";	// JSON lines file every run is appended to
+	
+	std::string serveSocket = "";	// Socket the sort service listens on
+	std::string clientSocket = "";	// Socket of the sort service the client sends -d to
+	bool sharedMemory{};			// Client sends the values through shared memory instead of the socket
+	int32_t requests = 1;			// Times the client sends -d
+	bool serviceStats{};			// Client prints the service statistics
+	bool serviceStop{};				// Client asks the service to stop
+	
+	int32_t processes{};		// Worker processes of a multi-process sort, 0 sorts in this process
+	
+	std::string batch = "";		// Manifest or directory of a batch run
+	int32_t batchCores{};		// Workers shared by the batch jobs, 0 uses every hardware thread
+	
+	std::string regressSuite = "";	// Manifest or directory of the regression gate cases
+	std::string saveBaseline = "";	// Baseline file the regression results are saved to
+	std::string baseline = "";		// Baseline file the regression results are compared to
+	int32_t regressThreshold{};		// Percent of throughput a case may lose, 0 uses the default
+	int32_t trials{};				// Timed runs per regression case, 0 uses the default
+	
+	std::vector<int32_t> data;
+};
+
+
+
+/*** Function Declarations ***/
+
+// Converts a command line name <bubble|insertion|merge|quick|blockmerge> to a SortAlgorithm (None if unknown)
+//
+SortAlgorithm parseAlgorithmName(std::string name);
+
+// Gets the command line name of 'algorithm' (ex. "merge")
+//
+std::string getAlgorithmKey(SortAlgorithm algorithm);
+
+// Gets the display name of 'algorithm' (ex. "Merge Sort")
+//
+std::string getAlgorithmName(SortAlgorithm algorithm);
+
+// Reads 'input' to its end in blocks of up to 'blockSize' bytes, handing each block to 'parse' cut after its
+// last whitespace (the number cut off is carried to the next block). Returns false if a read fails, a number
+// does not fit in a block, or 'parse' returns false
+//
+bool readNumberBlocks(FILE* input, size_t blockSize, std::function<bool(const char* text, size_t length)> parse);
+
+// Opens 'fileName', reads integers, and places them into 'buffer'. Returns false and sets 'error' if it fails
+//
+bool readTestData(std::string fileName, std::vector<int32_t>* buffer, std::string* error);
+
+// Same as readTestData(), but exits the program if it fails
+//
+void loadTestData(std::string fileName, std::vector<int32_t>* buffer);
+
+// Calls the correct sorting (or selection) function based on the values in 'param'. Quick sort is
+// replaced by counting sort when a min/max pre-scan finds few possible keys next to the data length
+//
+void runSortingAlgorithm(SortParameters* param);
+
+// Sorts data[0..n) where it lies with the algorithm of 'param' instead of 'param->data', for values that are
+// not in a vector (ex. the shared memory of a service request). Only the merge sorts have engines that
+// take raw memory, so it returns false without sorting for the other algorithms
+//
+bool runSortingAlgorithm(SortParameters* param, int32_t* data, size_t n);
+
+// Checks if the data in 'buffer' is sorted from smallest to largest
+//
+bool isSorted(std::vector<int32_t>* buffer);
+
+
+#endif
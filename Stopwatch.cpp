@@ -46,3 +46,8 @@ std::string Stopwatch::getFormattedTime()
 	
 	return time;
 }
+
+double Stopwatch::getSeconds()
+{
+	return this->duration.count();
+}
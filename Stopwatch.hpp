@@ -21,11 +21,12 @@ public:
 	void reset();
 	
 	std::string getFormattedTime();
+	double getSeconds();
 	
 private:
 	
 	std::chrono::time_point<std::chrono::system_clock> start_t, end_t;
-	std::chrono::duration<double> duration;
+	std::chrono::duration<double> duration{};
 	
 	bool running = false;
 };
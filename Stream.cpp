@@ -0,0 +1,369 @@
+/**
+*  Stream.cpp
+*
+*  Defines the streaming input mode, which sorts chunks of the input while the rest is still being read
+*/
+
+#include "Stream.hpp"
+#include "Stopwatch.hpp"
+#include "CpuDispatch.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <stdlib.h>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+
+
+const size_t READ_BLOCK_SIZE = 1 << 20;
+
+
+/*** Data Structures ***/
+
+// Chunks shared by the reader and the sorting workers. A deque is used because adding a chunk
+// never moves the chunks that workers are already sorting
+//
+struct ChunkQueue
+{
+	std::mutex lock;
+	std::condition_variable ready;
+	
+	std::deque<std::vector<int32_t>> chunks;
+	size_t nextToSort{};
+	bool inputEnded{};
+};
+
+// A sorted run inside a merge buffer
+//
+struct Run
+{
+	size_t begin;
+	size_t end;
+};
+
+
+
+/*** Function Definitions ***/
+
+// Worker loop: sorts chunks in the order they were read until the input has ended and none are left
+//
+static void sortChunks(ChunkQueue* queue, SortAlgorithm algorithm)
+{
+	while (true)
+	{
+		std::vector<int32_t>* chunk;
+		
+		{
+			std::unique_lock<std::mutex> guard(queue->lock);
+			
+			queue->ready.wait(guard, [queue] { return queue->nextToSort < queue->chunks.size() || queue->inputEnded; });
+			
+			if (queue->nextToSort == queue->chunks.size())
+				return;
+			
+			chunk = &(queue->chunks[queue->nextToSort++]);
+		}
+		
+		SortParameters chunkParam{};
+		
+		chunkParam.algorithm = algorithm;
+		chunkParam.parallel = false;
+		chunkParam.data.swap(*chunk);
+		
+		runSortingAlgorithm(&chunkParam);
+		
+		chunk->swap(chunkParam.data);
+	}
+}
+
+
+// Hands a full chunk to the workers and starts a new one
+//
+static void publishChunk(ChunkQueue* queue, std::vector<int32_t>* chunk, size_t chunkSize)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue->lock);
+		
+		queue->chunks.push_back(std::move(*chunk));
+	}
+	
+	queue->ready.notify_one();
+	
+	/* Chunks larger than the default grow as they fill, so a huge --chunk-size does not allocate up front */
+	
+	*chunk = std::vector<int32_t>();
+	chunk->reserve(std::min(chunkSize, (size_t)DEFAULT_CHUNK_SIZE));
+}
+
+
+// Parses the whitespace separated integers in text[0..length) with the dispatched parser into 'values',
+// then moves them into chunks, publishing a chunk every 'chunkSize' values. Returns false if the text is
+// not valid
+//
+static bool parseBlock(const char* text, size_t length, std::vector<int32_t>* values, std::vector<int32_t>* chunk, ChunkQueue* queue, size_t chunkSize)
+{
+	values->clear();
+	
+	if (!parseIntegersKernel(text, length, values))
+	{
+		return false;
+	}
+	
+	size_t i = 0;
+	
+	while (i < values->size())
+	{
+		size_t count = std::min(chunkSize - chunk->size(), values->size() - i);
+		
+		chunk->insert(chunk->end(), values->begin() + i, values->begin() + i + count);
+		i += count;
+		
+		if (chunk->size() == chunkSize)
+		{
+			publishChunk(queue, chunk, chunkSize);
+		}
+	}
+	
+	return true;
+}
+
+
+// Reads 'input' block by block until it ends, handing every full chunk to the workers
+//
+static void readChunks(FILE* input, std::string name, ChunkQueue* queue, size_t chunkSize)
+{
+	std::vector<int32_t> values;
+	
+	std::vector<int32_t> chunk;
+	chunk.reserve(std::min(chunkSize, (size_t)DEFAULT_CHUNK_SIZE));
+	
+	bool parsed = readNumberBlocks(input, READ_BLOCK_SIZE, [&](const char* text, size_t length)
+	{
+		return parseBlock(text, length, &values, &chunk, queue, chunkSize);
+	});
+	
+	if (!parsed)
+	{
+		std::cout << "\n   ERROR: Failure occured while reading from \"" << name << "\"\n\n";
+		exit(2);
+	}
+	
+	if (!chunk.empty())
+	{
+		publishChunk(queue, &chunk, chunkSize);
+	}
+}
+
+
+// Finds how many values of 'a' come before position 'k' of the merge of 'a' and 'b' (merge path search)
+//
+static size_t mergePathSplit(const int32_t* a, size_t aLength, const int32_t* b, size_t bLength, size_t k)
+{
+	size_t low = (k > bLength) ? k - bLength : 0;
+	size_t high = std::min(k, aLength);
+	
+	while (low < high)
+	{
+		size_t i = low + (high - low) / 2;
+		
+		/* Take a[i] before b[k - i - 1] only when it is strictly smaller, so ties keep 'a' first */
+		
+		if (a[i] <= b[k - i - 1])
+			low = i + 1;
+		else
+			high = i;
+	}
+	
+	return low;
+}
+
+
+// Merges part [first..last) of the output of merging runs 'left' and 'right' of 'src' into 'dst'
+//
+static void mergeRunPart(int32_t* src, int32_t* dst, Run left, Run right, size_t first, size_t last)
+{
+	const int32_t* a = src + left.begin;
+	const int32_t* b = src + right.begin;
+	
+	size_t aLength = left.end - left.begin;
+	size_t bLength = right.end - right.begin;
+	
+	size_t i = mergePathSplit(a, aLength, b, bLength, first);
+	size_t iLast = mergePathSplit(a, aLength, b, bLength, last);
+	
+	std::merge(a + i, a + iLast, b + (first - i), b + (last - iLast), dst + left.begin + first);
+}
+
+
+// Merges the sorted chunks into 'out', pairing up runs each round. Every merge is split into equal
+// parts with a merge path search so all threads stay busy even when only one pair is left
+//
+static void mergeChunks(std::deque<std::vector<int32_t>>* chunks, std::vector<int32_t>* out, int32_t numThreads)
+{
+	size_t n = 0;
+	
+	for (std::vector<int32_t>& chunk : *chunks)
+	{
+		n += chunk.size();
+	}
+	
+	std::vector<int32_t> scratch(n);
+	std::vector<Run> runs;
+	
+	/* Gather the chunks into one buffer, freeing each as it is copied */
+	
+	size_t offset = 0;
+	
+	while (!chunks->empty())
+	{
+		std::copy(chunks->front().begin(), chunks->front().end(), scratch.begin() + offset);
+		
+		runs.push_back({ offset, offset + chunks->front().size() });
+		
+		offset += chunks->front().size();
+		
+		chunks->pop_front();
+	}
+	
+	out->resize(n);
+	
+	int32_t* src = scratch.data();
+	int32_t* dst = out->data();
+	
+	while (runs.size() > 1)
+	{
+		std::vector<Run> merged;
+		std::vector<std::thread> threads;
+		
+		size_t pairs = runs.size() / 2;
+		size_t partsPerPair = std::max<size_t>(1, numThreads / pairs);
+		
+		for (size_t r = 0; r + 1 < runs.size(); r += 2)
+		{
+			size_t length = runs[r + 1].end - runs[r].begin;
+			
+			for (size_t part = 0; part < partsPerPair; part++)
+			{
+				size_t first = length * part / partsPerPair;
+				size_t last = length * (part + 1) / partsPerPair;
+				
+				threads.push_back(std::thread(mergeRunPart, src, dst, runs[r], runs[r + 1], first, last));
+				
+				if ((int32_t)threads.size() == numThreads)
+				{
+					for (std::thread& t : threads)
+						t.join();
+					
+					threads.clear();
+				}
+			}
+			
+			merged.push_back({ runs[r].begin, runs[r + 1].end });
+		}
+		
+		if (runs.size() % 2)
+		{
+			Run last = runs.back();
+			
+			std::copy(src + last.begin, src + last.end, dst + last.begin);
+			
+			merged.push_back(last);
+		}
+		
+		for (std::thread& t : threads)
+		{
+			t.join();
+		}
+		
+		std::swap(src, dst);
+		
+		runs = merged;
+	}
+	
+	if (src != out->data())
+	{
+		std::copy(src, src + n, out->data());
+	}
+}
+
+
+void streamSort(SortParameters* param, StreamInfo* info)
+{
+	bool useStdin = (param->dataFile == "" || param->dataFile == "-");
+	
+	std::string name = (useStdin) ? "stdin" : param->dataFile;
+	
+	FILE* input = (useStdin) ? stdin : fopen(param->dataFile.c_str(), "rb");
+	
+	if (input == nullptr)
+	{
+		std::cout << "\n   ERROR: Cannot open file \"" << param->dataFile << "\"\n\n";
+		exit(2);
+	}
+	
+	ChunkQueue queue;
+	
+	info->numWorkers = (param->parallel) ? param->numThreads : 1;
+	
+	std::vector<std::thread> workers;
+	
+	for (int32_t w = 0; w < info->numWorkers; w++)
+	{
+		workers.push_back(std::thread(sortChunks, &queue, param->algorithm));
+	}
+	
+	
+	/* Read on this thread while the workers sort */
+	
+	Stopwatch readTimer;
+	readTimer.start();
+	
+	readChunks(input, name, &queue, param->chunkSize);
+	
+	readTimer.stop();
+	
+	if (!useStdin)
+	{
+		fclose(input);
+	}
+	
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		
+		queue.inputEnded = true;
+	}
+	
+	queue.ready.notify_all();
+	
+	
+	/* Wait for the chunks still being sorted */
+	
+	Stopwatch drainTimer;
+	drainTimer.start();
+	
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	
+	drainTimer.stop();
+	
+	info->numChunks = queue.chunks.size();
+	
+	
+	/* Merge */
+	
+	Stopwatch mergeTimer;
+	mergeTimer.start();
+	
+	mergeChunks(&(queue.chunks), &(param->data), info->numWorkers);
+	
+	mergeTimer.stop();
+	
+	info->readTime = readTimer.getSeconds();
+	info->drainTime = drainTimer.getSeconds();
+	info->mergeTime = mergeTimer.getSeconds();
+}
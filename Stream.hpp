@@ -0,0 +1,39 @@
+/**
+*  Stream.hpp
+*
+*  Declares the streaming input mode, which sorts chunks of the input while the rest is still being read
+*/
+
+#ifndef STREAM_HPP_MULTITHREADED_SORTING
+#define STREAM_HPP_MULTITHREADED_SORTING
+
+
+#include "SortRunner.hpp"
+
+#include <cstddef>
+
+
+/*** Data Structures ***/
+
+struct StreamInfo
+{
+	size_t numChunks{};
+	int32_t numWorkers{};
+	
+	double readTime{};		// Reading and parsing the input, in seconds
+	double drainTime{};		// Waiting for the last chunks to be sorted after the input ended
+	double mergeTime{};		// Merging the sorted chunks
+};
+
+
+
+/*** Function Declarations ***/
+
+// Reads integers from 'param->dataFile' (or stdin when it is "" or "-") in chunks of 'param->chunkSize'
+// values. Each full chunk is sorted by a worker thread with the sequential version of 'param->algorithm'
+// while the next chunk is read, then the sorted chunks are merged into 'param->data'
+//
+void streamSort(SortParameters* param, StreamInfo* info);
+
+
+#endif
@@ -0,0 +1,132 @@
+/**
+*  stringData.cpp
+*
+*  Defines loading, saving and verification of text lines for the string sorts
+*/
+
+#include "stringSorts.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <stdlib.h>
+#include <cstring>
+
+
+void loadStringFile(std::string fileName, StringArena* arena)
+{
+	std::ifstream dataFile(fileName, std::ios::binary | std::ios::ate);
+	
+	if (!dataFile.is_open())
+	{
+		std::cout << "\n   ERROR: Cannot open file \"" << fileName << "\"\n\n";
+		
+		exit(2);
+	}
+	
+	size_t fileSize = dataFile.tellg();
+	
+	/* One extra byte ends the last line when the file does not end with a newline */
+	
+	arena->bytes.resize(fileSize + 1);
+	arena->offsets.clear();
+	
+	dataFile.seekg(0);
+	
+	if (!dataFile.read(arena->bytes.data(), fileSize))
+	{
+		std::cout << "\n   ERROR: Failure occured while reading from \"" << fileName << "\"\n\n";
+		
+		exit(2);
+	}
+	
+	arena->bytes[fileSize] = '\n';
+	
+	size_t start = 0;
+	
+	for (size_t i = 0; i <= fileSize; i++)
+	{
+		if (arena->bytes[i] != '\n')
+			continue;
+		
+		/* A newline right at the end of the file does not start another (empty) line */
+		
+		if (i == fileSize && start == fileSize)
+			break;
+		
+		if (i > start && arena->bytes[i - 1] == '\r')
+			arena->bytes[i - 1] = '\0';
+		
+		arena->bytes[i] = '\0';
+		arena->offsets.push_back(start);
+		
+		start = i + 1;
+	}
+}
+
+
+uint64_t loadStringPrefix(const char* text, size_t depth)
+{
+	const unsigned char* bytes = (const unsigned char*)text + depth;
+	uint64_t prefix = 0;
+	
+	for (int b = 0; b < 8; b++)
+	{
+		prefix |= (uint64_t)bytes[b] << (56 - 8 * b);
+		
+		if (bytes[b] == 0)
+			break;
+	}
+	
+	return prefix;
+}
+
+
+void makeStringKeys(StringArena* arena, std::vector<StringKey>* keys)
+{
+	keys->resize(arena->size());
+	
+	for (size_t i = 0; i < arena->size(); i++)
+	{
+		const char* text = arena->bytes.data() + arena->offsets[i];
+		
+		keys->at(i) = { loadStringPrefix(text, 0), text };
+	}
+}
+
+
+bool writeStringFile(std::vector<StringKey>* keys, std::string fileName)
+{
+	std::ofstream output(fileName, std::ios::binary);
+	
+	if (!output.is_open())
+	{
+		return false;
+	}
+	
+	for (StringKey& key : *keys)
+	{
+		output.write(key.text, strlen(key.text));
+		output.put('\n');
+	}
+	
+	return output.good();
+}
+
+
+bool isStringSorted(std::vector<StringKey>* keys, StringArena* arena)
+{
+	if (keys->size() != arena->size())
+	{
+		return false;
+	}
+	
+	for (size_t i = 1; i < keys->size(); i++)
+	{
+		if (strcmp(keys->at(i - 1).text, keys->at(i).text) > 0)
+		{
+			return false;
+		}
+	}
+	
+	return true;
+}
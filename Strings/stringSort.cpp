@@ -0,0 +1,291 @@
+/**
+*  stringSort.cpp
+*
+*  Defines the sequential and parallel multikey quicksorts for text lines
+*/
+
+#include "stringSorts.hpp"
+
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstring>
+
+
+const size_t STRING_INSERTION_CUTOFF = 16;			// Ranges this small are insertion sorted
+const size_t PARALLEL_STRING_CUTOFF = 1 << 14;		// Fewer lines than this are sorted on one thread
+const size_t STRING_OVERSAMPLING = 32;				// Sampled lines per thread when choosing the splitters
+
+
+// Compares two keys whose lines are known to be equal up to 'depth'
+//
+static inline bool keyLess(const StringKey& a, const StringKey& b, size_t depth)
+{
+	if (a.prefix != b.prefix)
+		return a.prefix < b.prefix;
+	
+	/* Equal prefixes that end in '\0' are equal lines, otherwise the rest of the lines decides */
+	
+	if ((a.prefix & 0xFF) == 0)
+		return false;
+	
+	return strcmp(a.text + depth + 8, b.text + depth + 8) < 0;
+}
+
+
+static void insertionSortKeys(StringKey* keys, size_t n, size_t depth)
+{
+	for (size_t i = 1; i < n; i++)
+	{
+		StringKey key = keys[i];
+		size_t j = i;
+		
+		while (j > 0 && keyLess(key, keys[j - 1], depth))
+		{
+			keys[j] = keys[j - 1];
+			j--;
+		}
+		
+		keys[j] = key;
+	}
+}
+
+
+// Sorts keys[0..n), whose lines are all equal up to 'depth' and whose prefixes hold the 8 bytes from 'depth'
+//
+static void multikeySort(StringKey* keys, size_t n, size_t depth)
+{
+	while (n > STRING_INSERTION_CUTOFF)
+	{
+		uint64_t a = keys[0].prefix;
+		uint64_t b = keys[n / 2].prefix;
+		uint64_t c = keys[n - 1].prefix;
+		
+		uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+		
+		/* Three-way partition on the prefix: keys[0..lt) < pivot, keys[lt..gt) == pivot, keys[gt..n) > pivot */
+		
+		size_t lt = 0;
+		size_t i = 0;
+		size_t gt = n;
+		
+		while (i < gt)
+		{
+			if (keys[i].prefix < pivot)
+				std::swap(keys[lt++], keys[i++]);
+			else if (keys[i].prefix > pivot)
+				std::swap(keys[i], keys[--gt]);
+			else
+				i++;
+		}
+		
+		size_t less = lt;
+		size_t equal = gt - lt;
+		size_t greater = n - gt;
+		
+		/* The equal lines continue past these 8 bytes unless the pivot ends in '\0' */
+		
+		bool equalDone = (pivot & 0xFF) == 0;
+		
+		if (!equalDone)
+		{
+			for (size_t k = lt; k < gt; k++)
+			{
+				keys[k].prefix = loadStringPrefix(keys[k].text, depth + 8);
+			}
+		}
+		
+		/* Recurse into the two smaller parts and loop on the largest, so the stack stays O(log n) deep */
+		
+		if (less >= greater && less >= equal)
+		{
+			multikeySort(keys + gt, greater, depth);
+			
+			if (!equalDone)
+				multikeySort(keys + lt, equal, depth + 8);
+			
+			n = less;
+		}
+		else if (greater >= equal)
+		{
+			multikeySort(keys, less, depth);
+			
+			if (!equalDone)
+				multikeySort(keys + lt, equal, depth + 8);
+			
+			keys += gt;
+			n = greater;
+		}
+		else
+		{
+			multikeySort(keys, less, depth);
+			multikeySort(keys + gt, greater, depth);
+			
+			if (equalDone)
+				return;
+			
+			keys += lt;
+			n = equal;
+			depth += 8;
+		}
+	}
+	
+	insertionSortKeys(keys, n, depth);
+}
+
+
+void seqSortStrings(std::vector<StringKey>* keys)
+{
+	if (keys == nullptr || keys->empty())
+		return;
+	
+	multikeySort(keys->data(), keys->size(), 0);
+}
+
+
+// Finds the range (0 to splitters.size()) of every key in keys[left..right) and counts the keys of each range
+//
+static void findRanges(std::vector<StringKey>* keys, std::vector<StringKey>* splitters, std::vector<uint8_t>* ranges, size_t left, size_t right, size_t* counts)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		StringKey& key = keys->at(i);
+		
+		size_t range = std::upper_bound(splitters->begin(), splitters->end(), key,
+		                                [](const StringKey& a, const StringKey& b) { return keyLess(a, b, 0); }) - splitters->begin();
+		
+		ranges->at(i) = (uint8_t)range;
+		counts[range]++;
+	}
+}
+
+
+// Moves keys[left..right) to 'dst' using the running range positions in 'offsets'
+//
+static void scatterRanges(std::vector<StringKey>* keys, std::vector<StringKey>* dst, std::vector<uint8_t>* ranges, size_t left, size_t right, size_t* offsets)
+{
+	for (size_t i = left; i < right; i++)
+	{
+		dst->at(offsets[ranges->at(i)]++) = keys->at(i);
+	}
+}
+
+
+static void sortRange(std::vector<StringKey>* keys, size_t left, size_t right)
+{
+	multikeySort(keys->data() + left, right - left, 0);
+}
+
+
+void parSortStrings(std::vector<StringKey>* keys, int32_t numThreads)
+{
+	if (keys == nullptr || keys->empty())
+		return;
+	
+	size_t n = keys->size();
+	
+	if (numThreads <= 1 || n < PARALLEL_STRING_CUTOFF)
+	{
+		seqSortStrings(keys);
+		return;
+	}
+	
+	/* Splitters from a sorted random sample. Sampling whole lines (instead of splitting on the first
+	   bytes like an MSD radix pass) keeps the ranges balanced when most lines share a long prefix */
+	
+	std::mt19937_64 rng(n);
+	std::uniform_int_distribution<size_t> pick(0, n - 1);
+	
+	std::vector<StringKey> samples(numThreads * STRING_OVERSAMPLING);
+	
+	for (StringKey& sample : samples)
+	{
+		sample = keys->at(pick(rng));
+	}
+	
+	multikeySort(samples.data(), samples.size(), 0);
+	
+	std::vector<StringKey> splitters;
+	
+	for (int32_t t = 1; t < numThreads; t++)
+	{
+		const char* text = samples[t * samples.size() / numThreads].text;
+		
+		splitters.push_back({ loadStringPrefix(text, 0), text });
+	}
+	
+	/* Count and scatter the keys by range, each thread over its own block */
+	
+	size_t blockSize = (n + numThreads - 1) / numThreads;
+	
+	std::vector<uint8_t> ranges(n);
+	std::vector<std::vector<size_t>> counts(numThreads, std::vector<size_t>(numThreads));
+	std::vector<std::thread> threads;
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(t * blockSize, n);
+		size_t right = std::min(left + blockSize, n);
+		
+		threads.push_back(std::thread(findRanges, keys, &splitters, &ranges, left, right, counts[t].data()));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	/* Turn the counts into starting positions: by range, then by thread */
+	
+	std::vector<size_t> rangeStarts(numThreads + 1);
+	size_t position = 0;
+	
+	for (int32_t range = 0; range < numThreads; range++)
+	{
+		rangeStarts[range] = position;
+		
+		for (int32_t t = 0; t < numThreads; t++)
+		{
+			size_t count = counts[t][range];
+			
+			counts[t][range] = position;
+			
+			position += count;
+		}
+	}
+	
+	rangeStarts[numThreads] = n;
+	
+	std::vector<StringKey> scratch(n);
+	
+	threads.clear();
+	
+	for (int32_t t = 0; t < numThreads; t++)
+	{
+		size_t left = std::min(t * blockSize, n);
+		size_t right = std::min(left + blockSize, n);
+		
+		threads.push_back(std::thread(scatterRanges, keys, &scratch, &ranges, left, right, counts[t].data()));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+	
+	keys->swap(scratch);
+	
+	/* Every range only holds lines between its splitters, so sorting the ranges sorts everything */
+	
+	threads.clear();
+	
+	for (int32_t range = 0; range < numThreads; range++)
+	{
+		threads.push_back(std::thread(sortRange, keys, rangeStarts[range], rangeStarts[range + 1]));
+	}
+	
+	for (std::thread& t : threads)
+	{
+		t.join();
+	}
+}
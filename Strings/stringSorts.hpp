@@ -0,0 +1,78 @@
+/**
+*  stringSorts.hpp
+*
+*  Declares the text line (variable length key) sorting functions
+*/
+
+#ifndef STRING_SORTS_HPP_MULTITHREADED_SORTING
+#define STRING_SORTS_HPP_MULTITHREADED_SORTING
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+/*** Data Structures ***/
+
+// Every line of a file in one buffer. The newlines are replaced by '\0', so line i is the C string
+// starting at bytes[offsets[i]] (lines holding '\0' bytes of their own are compared up to the first one)
+//
+struct StringArena
+{
+	std::vector<char> bytes;
+	std::vector<uint64_t> offsets;
+	
+	size_t size() { return offsets.size(); }
+};
+
+// What the sorts move around instead of the lines: the next 8 bytes of the line from the current depth,
+// big endian so that comparing prefixes as integers compares the bytes in order, and the line itself.
+// Most comparisons are settled by the prefix without following the pointer
+//
+struct StringKey
+{
+	uint64_t prefix;
+	const char* text;
+};
+
+
+/*** String Data (stringData.cpp) ***/
+
+// Reads the newline separated lines of 'fileName' into 'arena' ("\r\n" line endings are accepted)
+//
+void loadStringFile(std::string fileName, StringArena* arena);
+
+// Makes one key per line of 'arena', in file order, with the prefix of the first 8 bytes
+//
+void makeStringKeys(StringArena* arena, std::vector<StringKey>* keys);
+
+// Gets the 8 bytes of 'text' starting at 'depth' as a big endian prefix, padded with zeros after the end
+// of the string ('depth' must not be past the end)
+//
+uint64_t loadStringPrefix(const char* text, size_t depth);
+
+// Saves the lines in the order of 'keys', one per line
+//
+bool writeStringFile(std::vector<StringKey>* keys, std::string fileName);
+
+// Checks that the lines of 'keys' are in byte order, and that there are as many as in 'arena'
+//
+bool isStringSorted(std::vector<StringKey>* keys, StringArena* arena);
+
+
+/*** String Sorting (stringSort.cpp) ***/
+
+// Multikey quicksort: three-way partitions on the cached 8 byte prefix, and only the keys equal to the
+// pivot move on to the next 8 bytes, so common prefixes (ex. "https://") are passed over 8 bytes at a time
+//
+void seqSortStrings(std::vector<StringKey>* keys);
+
+// Splits the keys into one range per thread around sampled splitter lines, then sorts the ranges with
+// multikey quicksort at the same time
+//
+void parSortStrings(std::vector<StringKey>* keys, int32_t numThreads);
+
+
+#endif
@@ -0,0 +1,280 @@
+/**
+*  Sweep.cpp
+*
+*  Defines the thread count / dataset scaling sweep
+*/
+
+#include "Sweep.hpp"
+#include "Stopwatch.hpp"
+#include "ResultsLog.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+
+
+// Sorts a fresh copy of 'input' 'trials' times and returns the median run time
+//
+static double timeTrials(SortParameters* param, std::vector<int32_t>* input, int32_t trials, bool* sortedCorrectly)
+{
+	std::vector<double> times;
+	
+	*sortedCorrectly = true;
+	
+	for (int32_t trial = 0; trial < trials; trial++)
+	{
+		param->data = *input;
+		
+		Stopwatch timer;
+		timer.start();
+		
+		runSortingAlgorithm(param);
+		
+		timer.stop();
+		
+		times.push_back(timer.getSeconds());
+		
+		if (param->verify && !isSorted(&(param->data)))
+		{
+			*sortedCorrectly = false;
+		}
+	}
+	
+	std::sort(times.begin(), times.end());
+	
+	size_t mid = times.size() / 2;
+	
+	return (times.size() % 2) ? times[mid] : (times[mid - 1] + times[mid]) / 2;
+}
+
+
+// Fills in the speedup, efficiency and serial fraction columns of one algorithm/dataset group,
+// where 'results[first]' is the sequential baseline
+//
+static void computeScaling(std::vector<SweepResult>* results, size_t first, size_t last)
+{
+	double baseline = results->at(first).time;
+	
+	double sumXY = 0.0;
+	double sumXX = 0.0;
+	
+	for (size_t i = first; i < last; i++)
+	{
+		SweepResult* r = &(results->at(i));
+		
+		double p = r->numThreads;
+		
+		r->speedup = (r->time > 0.0) ? baseline / r->time : 0.0;
+		r->efficiency = r->speedup / p;
+		
+		if (r->parallel && r->numThreads > 1 && r->speedup > 0.0)
+		{
+			/* Karp-Flatt metric: e = (1/S - 1/p) / (1 - 1/p) */
+			
+			double x = 1.0 - 1.0 / p;
+			double y = 1.0 / r->speedup - 1.0 / p;
+			
+			r->karpFlatt = y / x;
+			
+			sumXY += x * y;
+			sumXX += x * x;
+		}
+	}
+	
+	/* Least squares fit of Amdahl's law 1/S = f + (1 - f)/p over every thread count */
+	
+	double fitted = (sumXX > 0.0) ? sumXY / sumXX : 0.0;
+	
+	for (size_t i = first; i < last; i++)
+	{
+		results->at(i).amdahlFraction = fitted;
+	}
+}
+
+
+std::vector<int32_t> getDefaultSweepThreads()
+{
+	int32_t hardwareThreads = std::thread::hardware_concurrency();
+	
+	int32_t limit = std::min(std::max(hardwareThreads, DEFAULT_NUM_THREADS), MAX_NUM_THREADS);
+	
+	std::vector<int32_t> threads;
+	
+	for (int32_t t = 1; t <= limit; t *= 2)
+	{
+		threads.push_back(t);
+	}
+	
+	if (threads.back() != limit)
+	{
+		threads.push_back(limit);
+	}
+	
+	return threads;
+}
+
+
+void runSweep(SweepParameters* sweep, std::vector<SweepResult>* results)
+{
+	for (std::string& dataFile : sweep->dataFiles)
+	{
+		std::vector<int32_t> input;
+		
+		loadTestData(dataFile, &input);
+		
+		for (SortAlgorithm algorithm : sweep->algorithms)
+		{
+			SortParameters param{};
+			
+			param.dataFile = dataFile;
+			param.algorithm = algorithm;
+			param.verify = sweep->verify;
+			
+			size_t first = results->size();
+			
+			for (size_t run = 0; run <= sweep->threadCounts.size(); run++)
+			{
+				/* Run 0 is the sequential baseline, the rest use each thread count */
+				
+				param.parallel = (run > 0);
+				param.numThreads = (run > 0) ? sweep->threadCounts[run - 1] : 1;
+				
+				std::cout << " " << std::left << std::setw(15) << getAlgorithmName(algorithm)
+				          << ((param.parallel) ? "par " : "seq ") << std::setw(4) << param.numThreads
+				          << dataFile << "... " << std::flush;
+				
+				SweepResult result{};
+				
+				result.algorithm = algorithm;
+				result.dataFile = dataFile;
+				result.dataLength = input.size();
+				result.parallel = param.parallel;
+				result.numThreads = param.numThreads;
+				result.verified = sweep->verify;
+				
+				result.time = timeTrials(&param, &input, sweep->trials, &(result.sortedCorrectly));
+				
+				std::cout << result.time << " seconds";
+				
+				if (result.verified && !result.sortedCorrectly)
+				{
+					std::cout << "  (WARNING: not sorted)";
+				}
+				
+				std::cout << "\n";
+				
+				results->push_back(result);
+			}
+			
+			computeScaling(results, first, results->size());
+		}
+	}
+}
+
+
+// Gets the verification column value of 'result'
+//
+static std::string verificationStatus(SweepResult* result)
+{
+	if (!result->verified)
+		return "disabled";
+	
+	return (result->sortedCorrectly) ? "passed" : "failed";
+}
+
+
+bool writeSweepCSV(std::vector<SweepResult>* results, std::string fileName)
+{
+	std::ofstream csv(fileName);
+	
+	if (!csv.is_open())
+	{
+		return false;
+	}
+	
+	csv << "algorithm,version,threads,dataset,size,time,speedup,efficiency,karp_flatt,amdahl_serial_fraction,verification\n";
+	
+	csv << std::setprecision(6) << std::fixed;
+	
+	for (SweepResult& r : *results)
+	{
+		csv << getAlgorithmKey(r.algorithm) << ","
+		    << ((r.parallel) ? "parallel" : "sequential") << ","
+		    << r.numThreads << ","
+		    << r.dataFile << ","
+		    << r.dataLength << ","
+		    << r.time << ","
+		    << r.speedup << ","
+		    << r.efficiency << ",";
+		
+		if (r.parallel && r.numThreads > 1)
+		{
+			csv << r.karpFlatt;
+		}
+		
+		csv << "," << r.amdahlFraction << "," << verificationStatus(&r) << "\n";
+	}
+	
+	return true;
+}
+
+
+bool writeSweepJSON(SweepParameters* sweep, std::vector<SweepResult>* results, std::string timestamp, std::string fileName)
+{
+	std::ofstream json(fileName);
+	
+	if (!json.is_open())
+	{
+		return false;
+	}
+	
+	json << std::setprecision(6) << std::fixed;
+	
+	json << "{\n";
+	json << "  \"timestamp\": " << jsonString(timestamp) << ",\n";
+	json << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+	json << "  \"trials\": " << sweep->trials << ",\n";
+	
+	json << "  \"thread_counts\": [";
+	
+	for (size_t i = 0; i < sweep->threadCounts.size(); i++)
+	{
+		json << ((i) ? ", " : "") << sweep->threadCounts[i];
+	}
+	
+	json << "],\n";
+	json << "  \"results\": [\n";
+	
+	for (size_t i = 0; i < results->size(); i++)
+	{
+		SweepResult* r = &(results->at(i));
+		
+		json << "    {"
+		     << "\"algorithm\": " << jsonString(getAlgorithmKey(r->algorithm)) << ", "
+		     << "\"parallel\": " << ((r->parallel) ? "true" : "false") << ", "
+		     << "\"threads\": " << r->numThreads << ", "
+		     << "\"dataset\": " << jsonString(r->dataFile) << ", "
+		     << "\"size\": " << r->dataLength << ", "
+		     << "\"time\": " << r->time << ", "
+		     << "\"speedup\": " << r->speedup << ", "
+		     << "\"efficiency\": " << r->efficiency << ", "
+		     << "\"karp_flatt\": ";
+		
+		if (r->parallel && r->numThreads > 1)
+			json << r->karpFlatt;
+		else
+			json << "null";
+		
+		json << ", \"amdahl_serial_fraction\": " << r->amdahlFraction << ", "
+		     << "\"verification\": " << jsonString(verificationStatus(r)) << "}"
+		     << ((i + 1 < results->size()) ? ",\n" : "\n");
+	}
+	
+	json << "  ]\n";
+	json << "}\n";
+	
+	return true;
+}
@@ -0,0 +1,69 @@
+/**
+*  Sweep.hpp
+*
+*  Declares the thread count / dataset scaling sweep
+*/
+
+#ifndef SWEEP_HPP_MULTITHREADED_SORTING
+#define SWEEP_HPP_MULTITHREADED_SORTING
+
+
+#include "SortRunner.hpp"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+/*** Data Structures ***/
+
+struct SweepParameters
+{
+	std::vector<SortAlgorithm> algorithms;
+	std::vector<std::string> dataFiles;
+	std::vector<int32_t> threadCounts;
+	int32_t trials = 3;
+	bool verify{};
+};
+
+struct SweepResult
+{
+	SortAlgorithm algorithm{};
+	std::string dataFile;
+	size_t dataLength{};
+	bool parallel{};
+	int32_t numThreads = 1;
+	
+	double time{};				// Median of all trials, in seconds
+	double speedup{};			// Sequential time / parallel time
+	double efficiency{};		// speedup / numThreads
+	double karpFlatt{};			// Serial fraction measured at this thread count (only valid when numThreads > 1)
+	double amdahlFraction{};	// Serial fraction fitted over every thread count of the algorithm/dataset pair
+	
+	bool verified{};
+	bool sortedCorrectly{};
+};
+
+
+
+/*** Function Declarations ***/
+
+// Gets the thread counts used when none are given: powers of two up to the number of hardware threads
+//
+std::vector<int32_t> getDefaultSweepThreads();
+
+// Runs every algorithm in 'sweep' on every dataset, once sequentially as a baseline and once per
+// thread count in parallel, then appends one result per run to 'results'
+//
+void runSweep(SweepParameters* sweep, std::vector<SweepResult>* results);
+
+// Saves the sweep results as a ".csv" table
+//
+bool writeSweepCSV(std::vector<SweepResult>* results, std::string fileName);
+
+// Saves the sweep setup and results as a ".json" document
+//
+bool writeSweepJSON(SweepParameters* sweep, std::vector<SweepResult>* results, std::string timestamp, std::string fileName);
+
+
+#endif
@@ -0,0 +1,128 @@
+/**
+*  ThreadPool.cpp
+*
+*  Defines a fixed size pool of worker threads that run queued tasks
+*/
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(int32_t numThreads)
+{
+	for (int32_t w = 0; w < numThreads; w++)
+	{
+		this->workers.push_back(std::thread(&ThreadPool::workerLoop, this, w));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		
+		this->stopping = true;
+	}
+	
+	this->taskReady.notify_all();
+	
+	for (std::thread& worker : this->workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::submit(Task task)
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		
+		this->tasks.push_back(task);
+	}
+	
+	this->taskReady.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock<std::mutex> guard(this->lock);
+	
+	this->allDone.wait(guard, [this] { return this->tasks.empty() && this->busy == 0; });
+}
+
+int32_t ThreadPool::size()
+{
+	return this->workers.size();
+}
+
+int32_t ThreadPool::idle()
+{
+	std::lock_guard<std::mutex> guard(this->lock);
+	
+	return std::max<int32_t>(0, (int32_t)this->workers.size() - this->busy - (int32_t)this->tasks.size());
+}
+
+void ThreadPool::workerLoop(int32_t worker)
+{
+	std::unique_lock<std::mutex> guard(this->lock);
+	
+	while (true)
+	{
+		this->taskReady.wait(guard, [this] { return this->stopping || !this->tasks.empty(); });
+		
+		if (this->tasks.empty())
+		{
+			/* Only reached when stopping, after every queued task has run */
+			
+			return;
+		}
+		
+		Task task = this->tasks.front();
+		this->tasks.pop_front();
+		
+		this->busy++;
+		
+		guard.unlock();
+		
+		task(worker);
+		
+		guard.lock();
+		
+		this->busy--;
+		
+		if (this->tasks.empty() && this->busy == 0)
+		{
+			this->allDone.notify_all();
+		}
+	}
+}
+
+
+void acquireCores(CoreBudget* budget, int32_t cores)
+{
+	std::unique_lock<std::mutex> guard(budget->lock);
+	
+	uint64_t ticket = budget->nextTicket++;
+	
+	budget->released.wait(guard, [budget, ticket, cores] { return budget->nowServing == ticket && budget->available >= cores; });
+	
+	budget->available -= cores;
+	budget->nowServing++;
+	
+	guard.unlock();
+	
+	budget->released.notify_all();
+}
+
+
+void releaseCores(CoreBudget* budget, int32_t cores)
+{
+	{
+		std::lock_guard<std::mutex> guard(budget->lock);
+		
+		budget->available += cores;
+	}
+	
+	budget->released.notify_all();
+}
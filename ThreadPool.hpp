@@ -0,0 +1,82 @@
+/**
+*  ThreadPool.hpp
+*
+*  Declares a fixed size pool of worker threads that run queued tasks
+*/
+
+#ifndef THREAD_POOL_HPP_MULTITHREADED_SORTING
+#define THREAD_POOL_HPP_MULTITHREADED_SORTING
+
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+
+class ThreadPool
+{
+public:
+	
+	// A task receives the index of the worker running it (0 to size() - 1), so callers can keep
+	// per-worker state such as reusable buffers
+	//
+	typedef std::function<void(int32_t worker)> Task;
+	
+	ThreadPool(int32_t numThreads);
+	~ThreadPool();
+	
+	void submit(Task task);
+	void wait();
+	
+	int32_t size();
+	
+	// Workers that are neither running a task nor about to pick up one that is queued
+	//
+	int32_t idle();
+
+private:
+	
+	void workerLoop(int32_t worker);
+	
+	std::vector<std::thread> workers;
+	std::deque<Task> tasks;
+	
+	std::mutex lock;
+	std::condition_variable taskReady;
+	std::condition_variable allDone;
+	
+	int32_t busy = 0;
+	bool stopping = false;
+};
+
+
+// Cores shared by the tasks that are sorting, so parallel sorts inside pool tasks never run more threads
+// than there are cores. Tasks are served in the order they asked, so one waiting for several cores is not
+// passed over forever by single core tasks
+//
+struct CoreBudget
+{
+	std::mutex lock;
+	std::condition_variable released;
+	
+	int32_t available{};
+	
+	uint64_t nextTicket{};
+	uint64_t nowServing{};
+};
+
+
+// Waits until 'cores' cores are free and reserves them
+//
+void acquireCores(CoreBudget* budget, int32_t cores);
+
+// Returns 'cores' reserved cores to the budget
+//
+void releaseCores(CoreBudget* budget, int32_t cores);
+
+
+#endif
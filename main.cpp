@@ -4,8 +4,19 @@
 *  Defines the entry point of the program
 */
 
-#include "Sequential/seqSorts.hpp"
-#include "Parallel/parSorts.hpp"
+#include "SortRunner.hpp"
+#include "Sweep.hpp"
+#include "Stream.hpp"
+#include "Batch.hpp"
+#include "Distributed.hpp"
+#include "ResultsLog.hpp"
+#include "Service.hpp"
+#include "Regression.hpp"
+#include "CacheInfo.hpp"
+#include "MemoryInfo.hpp"
+#include "CpuDispatch.hpp"
+#include "Records/recordSorts.hpp"
+#include "Strings/stringSorts.hpp"
 #include "Stopwatch.hpp"
 
 #include <iostream>
@@ -13,42 +24,106 @@
 #include <string>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <ctime>
+#include <algorithm>
+#include <cctype>
+#include <thread>
+#include <filesystem>
+#include <mutex>
 
 
 
 /*** Constants ***/
 
-const char* usageStr = "\n Usage: sorttest [options...]\n\n -s             : Use sequential version of sorting algorithm\n -p             : Use parallel version of sorting algorithm\n -d --data      : Specify file name for input data\n -a --algorithm : Specify algorithm <bubble|insertion|merge|quick>\n -t --threads   : Specify number of threads to use for parallel sort\n -v --verify    : Verify that results are sorted\n    --help      : Show this message\n\n";
-
-const int32_t MIN_NUM_THREADS = 2;
-const int32_t MAX_NUM_THREADS = 100;
-const int32_t DEFAULT_NUM_THREADS = 4;
+const char* usageStr =
+	"\n Usage: sorttest [options...]\n\n"
+	" -s             : Use sequential version of sorting algorithm\n"
+	" -p             : Use parallel version of sorting algorithm\n"
+	" -d --data      : Specify file name for input data\n"
+	" -a --algorithm : Specify algorithm <bubble|insertion|merge|quick|blockmerge>\n"
+	" -t --threads   : Specify number of threads to use for parallel sort\n"
+	" -v --verify    : Verify that results are sorted\n"
+	"    --help      : Show this message\n\n"
+	" CPU:\n\n"
+	"    --cpu-path      : Run the kernels built for <scalar|sse4.2|avx2|avx512> instead of the best one this\n"
+	"                      CPU supports (detected at startup)\n\n"
+	" Memory:\n\n"
+	"    --no-huge-pages : Allocate buffers of 4 MB or more with plain malloc, instead of aligning them to 2 MB\n"
+	"                      and asking for transparent huge pages (madvise MADV_HUGEPAGE)\n\n"
+	" Quick sort:\n\n"
+	"    --no-counting   : Always quick sort, instead of switching to counting sort when the keys span a small range\n\n"
+	" Merge sort (-a merge):\n\n"
+	"    --low-memory    : Merge in place (SymMerge with rotations) instead of through scratch buffers as large\n"
+	"                      as the data: slower, but peak memory stays close to the size of the data itself\n\n"
+	" Cache-blocked merge sort (-a blockmerge):\n\n"
+	"    --tile-size     : Values per tile sorted inside the cache (default: half of L2 / 4 bytes)\n"
+	"    --merge-ways    : Number of runs merged per pass (default: L2 / 16 KB, from 2 to 32)\n\n"
+	" Streaming input:\n\n"
+	"    --stream        : Sort chunks of the input while the rest is read, then merge them (-d - or no -d reads stdin)\n"
+	"    --chunk-size    : Number of values per chunk for --stream (default: 1048576)\n\n"
+	" Selection (instead of a full sort, -a is not needed):\n\n"
+	"    --topk          : Keep only the K smallest values, sorted, and save them to a \".topk\" file\n"
+	"    --nth           : Find the value at index N (from 0) of the sorted order\n\n"
+	" Record sorting (stable, fixed width binary records: int32_t key + payload):\n\n"
+	"    --records       : Sort records of the given size in bytes from -d (4 to 1024, ex. 68 for a 64 byte payload)\n"
+	"    --layout        : Record layout <aos|soa> (array of structs or struct of arrays, default: aos)\n"
+	"    --engine        : Record and argsort engine <merge|radix> (default: merge)\n"
+	"    --column-width  : Payload column width in bytes for the soa layout (default: 8)\n\n"
+	" Argsort:\n\n"
+	"    --argsort       : Save the stably sorted order of -d as <32|64>-bit indices to a \".dump\" file instead of\n"
+	"                      sorting the values (uses --engine, the order is then applied to the values as a side column)\n\n"
+	" String sorting:\n\n"
+	"    --strings       : Sort the lines of -d as byte strings (ex. URLs or log keys) instead of integers, with\n"
+	"                      multikey quicksort on 8 byte prefixes cached next to each line, and save them in\n"
+	"                      sorted order to a \".dump\" file\n\n"
+	" Scaling sweep:\n\n"
+	"    --sweep         : Run each algorithm in -a (comma separated, or \"all\") on each file in -d\n"
+	"                      (comma separated), sequentially and at every thread count, and save the\n"
+	"                      time/speedup/efficiency table to \"sweep_<timestamp>.csv\" and \".json\"\n"
+	"    --sweep-threads : Comma separated thread counts for --sweep (default: 1,2,4,... up to the core count)\n"
+	"    --trials        : Number of timed runs per configuration, the median is kept (default: 3)\n\n"
+	" Sort service:\n\n"
+	"    --serve         : Run as a service that sorts requests sent to the given Unix domain socket, on a pool\n"
+	"                      of -t workers (large requests use the parallel version with -t threads) until it\n"
+	"                      gets SIGINT, SIGTERM or --stop\n"
+	"    --client        : Send -d to the service on the given socket to be sorted with -a (default: quick,\n"
+	"                      or merge with --shm). Exits with code 4 if a response was not sorted correctly\n"
+	"                      (with -v)\n"
+	"    --shm           : Send the values through shared memory instead of the socket. The merge sorts\n"
+	"                      (-a merge or blockmerge) sort them there, without copying them\n"
+	"    --requests      : Number of times the client sends -d (default: 1)\n"
+	"    --stats         : Print the service statistics (latency percentiles, queue depth, batching)\n"
+	"    --stop          : Ask the service to finish its requests and stop\n\n"
+	" Results log:\n\n"
+	"    --results       : JSON lines file every run appends its parameters, timings, counters and machine\n"
+	"                      fingerprint to (default: results.jsonl). Sweeps, batches, the regression gate and\n"
+	"                      the sort service append one line per configuration, job, trial or request\n\n"
+	" Multi-process sort:\n\n"
+	"    --processes     : Sort -d with -a over this many local worker processes (2 to 64), each running the\n"
+	"                      -s/-p version on its block, with splitters sampled from the sorted blocks and one\n"
+	"                      output shard per worker. Saves the time and bytes moved of every phase to\n"
+	"                      \"distributed_<timestamp>.report\"\n\n"
+	" Batch jobs:\n\n"
+	"    --batch         : Sort every file listed in the given manifest, or every file in the given directory,\n"
+	"                      in one process and save one report to \"batch_<timestamp>.report\" and \".csv\".\n"
+	"                      Manifest lines are \"<file> [algorithm] [seq|par] [threads]\", missing settings\n"
+	"                      come from -a, -s/-p and -t. Exits with code 4 if a job could not be loaded or\n"
+	"                      was not sorted correctly (with -v)\n"
+	"    --batch-cores   : Number of cores shared by the batch jobs (default: all hardware threads)\n\n"
+	" Regression gate:\n\n"
+	"    --regress       : Time every case of the given suite (a manifest or directory, as for --batch)\n"
+	"                      --trials times (default: 10) and compare the throughput to --baseline\n"
+	"    --baseline      : Baseline \".json\" file to compare to. Exits with code 3 if a case got slower by more\n"
+	"                      than --threshold on average, and is slower with 95% confidence (Welch's t-interval\n"
+	"                      over the trials)\n"
+	"    --save-baseline : Save the results of --regress as a new baseline \".json\" file\n"
+	"    --threshold     : Percent of throughput a case may lose before it counts as a regression (default: 5)\n\n";
 
 
 
 /*** Data Structures ***/
 
-enum class SortAlgorithm
-{
-	None,
-	Bubble,
-	Insertion,
-	Merge,
-	Quick
-};
-
-struct SortParameters
-{
-	std::string dataFile = "";
-	SortAlgorithm algorithm{};
-	int32_t numThreads = DEFAULT_NUM_THREADS;
-	bool parallel{};
-	bool verify{};
-	
-	std::vector<int32_t> data;
-};
-
 struct OutputInfo
 {
 	std::string timestamp;
@@ -56,16 +131,155 @@ struct OutputInfo
 	
 	bool sortedCorrectly{};
 	
+	std::string algorithmName;
+	size_t dataLength{};
+	
+	StreamInfo stream;
+	
 	std::string runTime;
+	double seconds{};		// 'runTime' as a number, for the results log
+	MemoryStats memory;		// Allocations, peak memory and page faults of the timed sort
+	
+	double loadTime{};		// Batch jobs: reading and parsing the data file, in seconds
+	double queueTime{};		// Service requests: waiting for a worker, in seconds
+	
+	DistributedResult* distributed{};	// Per phase times and bytes of a distributed sort, nullptr otherwise
 };
 
 
 
 /*** Function Definitions ***/
 
-// Parses the command line arguments and sets the values of 'param' appropriatly
+// Gets the value that follows the option 'arg', or exits if there is none
+//
+std::string getOptionValue(int argc, char** argv, int* argi, std::string arg)
+{
+	(*argi)++;
+	
+	if (*argi >= argc)
+	{
+		std::cout << "\n   ERROR: Missing value for " << arg << "\n\n";
+		exit(1);
+	}
+	
+	return argv[*argi];
+}
+
+
+// Converts the value 'num' of option 'arg' to an integer within ['min', 'max'], or exits if it is invalid
+//
+int32_t parseIntegerValue(std::string arg, std::string num, int32_t min, int32_t max)
+{
+	int32_t value = 0;
+	
+	if (num.empty() || num.find_first_not_of("0123456789") != std::string::npos)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " contains non-digit characters\n\n";
+		exit(1);
+	}
+	
+	try
+	{
+		value = std::stoi(num);
+	}
+	catch (std::invalid_argument const& e)
+	{
+		std::cout << "\n   ERROR: Invalid value for " << arg << "\n\n";
+		exit(1);
+	}
+	catch (std::out_of_range const& e)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " too large for 32-bit integer\n\n";
+		exit(1);
+	}
+	catch (std::exception const& e)
+	{
+		std::cout << "\n   ERROR: " << e.what() << "\n\n";
+		exit(1);
+	}
+	
+	if (value < min)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " must be at least " << min << "\n\n";
+		exit(1);
+	}
+	else if (value > max)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " must be no larger than " << max << "\n\n";
+		exit(1);
+	}
+	
+	return value;
+}
+
+
+// Converts the value 'num' of the size-like option 'arg' (ranks, counts and sizes in values) to an integer
+// within ['min', 'max'], or exits if it is invalid
+//
+size_t parseSizeValue(std::string arg, std::string num, size_t min, size_t max)
+{
+	unsigned long long value = 0;
+	
+	if (num.empty() || num.find_first_not_of("0123456789") != std::string::npos)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " contains non-digit characters\n\n";
+		exit(1);
+	}
+	
+	try
+	{
+		value = std::stoull(num);
+	}
+	catch (std::out_of_range const& e)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " too large for 64-bit integer\n\n";
+		exit(1);
+	}
+	catch (std::exception const& e)
+	{
+		std::cout << "\n   ERROR: Invalid value for " << arg << "\n\n";
+		exit(1);
+	}
+	
+	if (value < min)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " must be at least " << min << "\n\n";
+		exit(1);
+	}
+	else if (value > max)
+	{
+		std::cout << "\n   ERROR: Value for " << arg << " must be no larger than " << max << "\n\n";
+		exit(1);
+	}
+	
+	return (size_t)value;
+}
+
+
+// Splits a comma separated list (ex. "merge,quick") into its items
+//
+std::vector<std::string> splitList(std::string list)
+{
+	std::vector<std::string> items;
+	
+	std::stringstream listStream(list);
+	std::string item;
+	
+	while (std::getline(listStream, item, ','))
+	{
+		if (!item.empty())
+		{
+			items.push_back(item);
+		}
+	}
+	
+	return items;
+}
+
+
+// Parses the command line arguments and sets the values of 'param' and 'sweep' appropriatly
 //
-void parseCommandLineArgs(int argc, char** argv, SortParameters* param)
+void parseCommandLineArgs(int argc, char** argv, SortParameters* param, SweepParameters* sweep)
 {
 	if (argc == 1)
 	{
@@ -92,186 +306,250 @@ void parseCommandLineArgs(int argc, char** argv, SortParameters* param)
 		}
 		else if (arg == "-d" || arg == "--data")
 		{
-			argi++;
+			param->dataFile = getOptionValue(argc, argv, &argi, arg);
 			
-			if (argi < argc)
-			{
-				param->dataFile = argv[argi];
-			}
-			else
-			{
-				std::cout << "\n   ERROR: Missing value for " << arg << "\n\n";
-				exit(1);
-			}
+			sweep->dataFiles = splitList(param->dataFile);
 		}
 		else if (arg == "-a" || arg == "--algorithm")
 		{
-			argi++;
+			std::string sorts = getOptionValue(argc, argv, &argi, arg);
+			
+			if (sorts == "all")
+			{
+				sorts = "bubble,insertion,merge,quick,blockmerge";
+			}
 			
-			if (argi < argc)
+			sweep->algorithms.clear();
+			
+			for (std::string sort : splitList(sorts))
 			{
-				std::string sort = argv[argi];
+				SortAlgorithm algorithm = parseAlgorithmName(sort);
 				
-				if (sort == "bubble")
-					param->algorithm = SortAlgorithm::Bubble;
-				else if (sort == "insertion")
-					param->algorithm = SortAlgorithm::Insertion;
-				else if (sort == "merge")
-					param->algorithm = SortAlgorithm::Merge;
-				else if (sort == "quick")
-					param->algorithm = SortAlgorithm::Quick;
-				else
+				if (algorithm == SortAlgorithm::None)
 				{
 					std::cout << "\n   ERROR: Unrecognized value for " << arg <<"\n\n";
 					exit(1);
 				}
+				
+				sweep->algorithms.push_back(algorithm);
+			}
+			
+			param->algorithm = (sweep->algorithms.size() == 1) ? sweep->algorithms[0] : SortAlgorithm::None;
+		}
+		else if (arg == "-t" || arg == "--threads")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->numThreads = parseIntegerValue(arg, num, MIN_NUM_THREADS, MAX_NUM_THREADS);
+		}
+		else if (arg == "-v" || arg == "--verify")
+		{
+			param->verify = true;
+		}
+		else if (arg == "--cpu-path")
+		{
+			std::string name = getOptionValue(argc, argv, &argi, arg);
+			CpuPath path;
+			
+			if (!parseCpuPathName(name, &path))
+			{
+				std::cout << "\n   ERROR: Unknown CPU path \"" << name << "\"\n\n";
+				exit(1);
+			}
+			else if (!setCpuPath(path))
+			{
+				std::cout << "\n   ERROR: This CPU does not support the " << name << " path\n\n";
+				exit(1);
 			}
+		}
+		else if (arg == "--no-huge-pages")
+		{
+			setHugePageBuffers(false);
+		}
+		else if (arg == "--no-counting")
+		{
+			param->countingSort = false;
+		}
+		else if (arg == "--low-memory")
+		{
+			param->lowMemory = true;
+		}
+		else if (arg == "--tile-size")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->tileSize = parseSizeValue(arg, num, 1, SIZE_MAX);
+		}
+		else if (arg == "--merge-ways")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->mergeWays = parseIntegerValue(arg, num, 2, 1024);
+		}
+		else if (arg == "--stream")
+		{
+			param->stream = true;
+		}
+		else if (arg == "--chunk-size")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->chunkSize = parseSizeValue(arg, num, 1, SIZE_MAX / sizeof(int32_t));
+		}
+		else if (arg == "--topk" || arg == "--nth")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->selection = (arg == "--topk") ? SelectionMode::TopK : SelectionMode::Nth;
+			param->selectRank = parseSizeValue(arg, num, (arg == "--topk") ? 1 : 0, SIZE_MAX);
+		}
+		else if (arg == "--records")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->recordSize = parseIntegerValue(arg, num, MIN_RECORD_SIZE, MAX_RECORD_SIZE);
+		}
+		else if (arg == "--strings")
+		{
+			param->strings = true;
+		}
+		else if (arg == "--layout")
+		{
+			std::string layout = getOptionValue(argc, argv, &argi, arg);
+			
+			if (layout == "aos")
+				param->recordLayout = RecordLayout::ArrayOfStructs;
+			else if (layout == "soa")
+				param->recordLayout = RecordLayout::StructOfArrays;
 			else
 			{
-				std::cout << "\n   ERROR: Missing value for " << arg << "\n\n";
+				std::cout << "\n   ERROR: Unrecognized value for " << arg <<"\n\n";
 				exit(1);
 			}
 		}
-		else if (arg == "-t" || arg == "--threads")
+		else if (arg == "--engine")
 		{
-			argi++;
+			std::string engine = getOptionValue(argc, argv, &argi, arg);
 			
-			if (argi < argc)
+			if (engine == "merge")
+				param->recordEngine = RecordEngine::Merge;
+			else if (engine == "radix")
+				param->recordEngine = RecordEngine::Radix;
+			else
 			{
-				std::string num = argv[argi];
-				
-				if (num.find_first_not_of("0123456789") == std::string::npos)
-				{
-					try
-					{
-						param->numThreads = std::stoi(num);
-						
-						if (param->numThreads < MIN_NUM_THREADS)
-						{
-							std::cout << "\n   ERROR: Value for " << arg << " must be at least " << MIN_NUM_THREADS << "\n\n";
-							exit(1);
-						}
-						else if (param->numThreads > MAX_NUM_THREADS)
-						{
-							std::cout << "\n   ERROR: Value for " << arg << " must be no larger than " << MAX_NUM_THREADS << "\n\n";
-							exit(1);
-						}
-					}
-					catch (std::invalid_argument const& e)
-					{
-						std::cout << "\n   ERROR: Invalid value for " << arg << "\n\n";
-						exit(1);
-					}
-					catch (std::out_of_range const& e)
-					{
-						std::cout << "\n   ERROR: Value for " << arg << " too large for 32-bit integer\n\n";
-						exit(1);
-					}
-					catch (std::exception const& e)
-					{
-						std::cout << "\n   ERROR: " << e.what() << "\n\n";
-						exit(1);
-					}
-				}
-				else
-				{
-					std::cout << "\n   ERROR: Value for " << arg << " contains non-digit characters\n\n";
-					exit(1);
-				}
+				std::cout << "\n   ERROR: Unrecognized value for " << arg <<"\n\n";
+				exit(1);
 			}
+		}
+		else if (arg == "--argsort")
+		{
+			std::string bits = getOptionValue(argc, argv, &argi, arg);
+			
+			if (bits == "32")
+				param->argsortBits = 32;
+			else if (bits == "64")
+				param->argsortBits = 64;
 			else
 			{
-				std::cout << "\n   ERROR: Missing value for " << arg << "\n\n";
+				std::cout << "\n   ERROR: Unrecognized value for " << arg <<"\n\n";
 				exit(1);
 			}
 		}
-		else if (arg == "-v" || arg == "--verify")
+		else if (arg == "--column-width")
 		{
-			param->verify = true;
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->columnWidth = parseIntegerValue(arg, num, 1, MAX_RECORD_SIZE);
 		}
-		else
+		else if (arg == "--sweep")
 		{
-			std::cout << "\n   ERROR: Unrecognized parameter: \"" << arg << "\"\n\n";
-			exit(1);
+			param->sweep = true;
 		}
-	}
-}
-
-
-// Opens 'fileName', reads integers, and places them into 'buffer' 
-//
-void loadTestData(std::string fileName, std::vector<int32_t>* buffer)
-{
-	std::ifstream dataFile;
-	
-	dataFile.open(fileName);
-	
-	if (dataFile.is_open())
-	{
-		int32_t next;
-		
-		while (dataFile >> next)
+		else if (arg == "--sweep-threads")
+		{
+			sweep->threadCounts.clear();
+			
+			for (std::string num : splitList(getOptionValue(argc, argv, &argi, arg)))
+			{
+				sweep->threadCounts.push_back(parseIntegerValue(arg, num, 1, MAX_NUM_THREADS));
+			}
+		}
+		else if (arg == "--serve")
 		{
-			buffer->push_back(next);
+			param->serveSocket = getOptionValue(argc, argv, &argi, arg);
 		}
-		
-		if (!dataFile.eof())
+		else if (arg == "--client")
+		{
+			param->clientSocket = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--shm")
+		{
+			param->sharedMemory = true;
+		}
+		else if (arg == "--requests")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->requests = parseIntegerValue(arg, num, 1, 1000000);
+		}
+		else if (arg == "--stats")
+		{
+			param->serviceStats = true;
+		}
+		else if (arg == "--stop")
+		{
+			param->serviceStop = true;
+		}
+		else if (arg == "--results")
+		{
+			param->resultsLog = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--processes")
 		{
-			dataFile.close();
+			std::string num = getOptionValue(argc, argv, &argi, arg);
 			
-			std::cout << "\n   ERROR: Failure occured while reading from \"" << fileName << "\"\n\n";
+			param->processes = parseIntegerValue(arg, num, MIN_NUM_PROCESSES, MAX_NUM_PROCESSES);
+		}
+		else if (arg == "--batch")
+		{
+			param->batch = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--batch-cores")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
 			
-			exit(2);
+			param->batchCores = parseIntegerValue(arg, num, 1, MAX_NUM_THREADS);
+		}
+		else if (arg == "--trials")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			sweep->trials = parseIntegerValue(arg, num, 1, 1000);
+			param->trials = sweep->trials;
+		}
+		else if (arg == "--regress")
+		{
+			param->regressSuite = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--baseline")
+		{
+			param->baseline = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--save-baseline")
+		{
+			param->saveBaseline = getOptionValue(argc, argv, &argi, arg);
+		}
+		else if (arg == "--threshold")
+		{
+			std::string num = getOptionValue(argc, argv, &argi, arg);
+			
+			param->regressThreshold = parseIntegerValue(arg, num, 1, 100);
 		}
-		
-		dataFile.close();
-	}
-	else
-	{
-		std::cout << "\n   ERROR: Cannot open file \"" << fileName << "\"\n\n";
-		
-		exit(2);
-	}
-}
-
-
-// Calls the correct sorting function based on the values in 'param'
-//
-void runSortingAlgorithm(SortParameters* param)
-{
-	switch (param->algorithm)
-	{
-	case SortAlgorithm::Bubble:
-		
-		if (param->parallel)
-			parBubbleSort(&(param->data), param->numThreads);
-		else
-			seqBubbleSort(&(param->data));
-		break;
-	
-	case SortAlgorithm::Insertion:
-		
-		if (param->parallel)
-			parInsertionSort(&(param->data), param->numThreads);
-		else
-			seqInsertionSort(&(param->data));
-		break;
-	
-	case SortAlgorithm::Merge:
-		
-		if (param->parallel)
-			parMergeSort(&(param->data), param->numThreads);
-		else
-			seqMergeSort(&(param->data));
-		break;
-	
-	case SortAlgorithm::Quick:
-		
-		if (param->parallel)
-			parQuickSort(&(param->data), param->numThreads);
 		else
-			seqQuickSort(&(param->data));
-		break;
+		{
+			std::cout << "\n   ERROR: Unrecognized parameter: \"" << arg << "\"\n\n";
+			exit(1);
+		}
 	}
 }
 
@@ -300,30 +578,12 @@ std::string getTimestamp()
 //
 std::string getTimestampedFilename(std::string timestamp, SortParameters* param)
 {
-	std::string file;
-	
-	switch (param->algorithm)
-	{
-	case SortAlgorithm::Bubble:
-		
-		file = "bubble_";
-		break;
-	
-	case SortAlgorithm::Insertion:
-		
-		file = "insertion_";
-		break;
-	
-	case SortAlgorithm::Merge:
-		
-		file = "merge_";
-		break;
+	std::string file = getAlgorithmKey(param->algorithm) + "_";
 	
-	case SortAlgorithm::Quick:
-		
-		file = "quick_";
-		break;
-	}
+	if (param->selection == SelectionMode::TopK)
+		file = "topk_";
+	else if (param->selection == SelectionMode::Nth)
+		file = "nth_";
 	
 	file.append(((param->parallel) ? "par_" : "seq_"));
 	
@@ -333,35 +593,19 @@ std::string getTimestampedFilename(std::string timestamp, SortParameters* param)
 }
 
 
-// Checks if the data in 'buffer' is sorted from smallest to largest
+// Saves the integer data to a ".dump" file (or a file with the given extension)
 //
-bool isSorted(std::vector<int32_t>* buffer)
+void dumpToFile(std::vector<int32_t>* buffer, std::string outputFileName, std::string extension = ".dump")
 {
-	for (int i = 0; i < buffer->size() - 1; i++)
+	outputFileName.append(extension);
+	
+	std::ofstream dump;
+	
+	dump.open(outputFileName);
+	
+	if (dump.is_open())
 	{
-		if (buffer->at(i) > buffer->at(i + 1))
-		{
-			return false;
-		}
-	}
-
-	return true;
-}
-
-
-// Saves the integer data to a ".dump" file
-//
-void dumpToFile(std::vector<int32_t>* buffer, std::string outputFileName)
-{
-	outputFileName.append(".dump");
-	
-	std::ofstream dump;
-	
-	dump.open(outputFileName);
-	
-	if (dump.is_open())
-	{
-		for (int i = 0; i < buffer->size(); i++)
+		for (size_t i = 0; i < buffer->size(); i++)
 		{
 			dump << buffer->at(i) << " ";
 		}
@@ -398,6 +642,43 @@ bool verifyResults(std::vector<int32_t>* buffer, std::string outputFileName)
 }
 
 
+// Checks the top-k values or nth element in 'param' against a full sort of the 'original' data. If the
+// top-k values are wrong, it calls dumpToFile()
+//
+bool verifySelection(SortParameters* param, std::vector<int32_t>* original, std::string outputFileName)
+{
+	std::cout << " Verifying... ";
+	
+	std::sort(original->begin(), original->end());
+	
+	bool correct;
+	
+	if (param->selection == SelectionMode::TopK)
+	{
+		size_t k = std::min(param->selectRank, original->size());
+		
+		correct = (param->data.size() == k) && std::equal(param->data.begin(), param->data.end(), original->begin());
+	}
+	else
+	{
+		correct = (param->selectedValue == original->at(param->selectRank));
+	}
+	
+	if (!correct)
+	{
+		std::cout << "\n\n   WARNING: Failed to select the correct values. Dumping results to \"" << outputFileName << ".dump\"\n\n";
+		
+		dumpToFile(&(param->data), outputFileName);
+		
+		return false;
+	}
+	
+	std::cout << "Done\n\n";
+	
+	return true;
+}
+
+
 // Saves a ".report" file with the results of the sorting
 //
 void generateReport(SortParameters* param, OutputInfo* info)
@@ -410,33 +691,52 @@ void generateReport(SortParameters* param, OutputInfo* info)
 	
 	reportStr << "Timestamp         : " << info->timestamp << "\n";
 	reportStr << "Test Data         : " << param->dataFile << "\n";
-	reportStr << "Data Length       : " << param->data.size() << "\n";
-	reportStr << "Sorting Algorithm : ";
+	reportStr << "Data Length       : " << info->dataLength << "\n";
+	reportStr << "Sorting Algorithm : " << info->algorithmName << "\n";
 	
-	switch (param->algorithm)
+	if (param->algorithm == SortAlgorithm::BlockMerge && param->tileSize > 0)
 	{
-	case SortAlgorithm::Bubble:
+		CacheInfo cache = getCacheInfo();
 		
-		reportStr << "Bubble Sort";
-		break;
+		reportStr << "Tile Size         : " << param->tileSize << " values (" << (param->tileSize * sizeof(int32_t) >> 10) << " KB)\n";
+		reportStr << "Merge Ways        : " << param->mergeWays << "\n";
+		reportStr << "Cache Sizes       : L1d " << (cache.l1d >> 10) << " KB, L2 " << (cache.l2 >> 10) << " KB, LLC " << (cache.llc >> 10) << " KB"
+		          << ((cache.detected) ? "" : " (not detected, defaults used)") << "\n";
+	}
 	
-	case SortAlgorithm::Insertion:
-		
-		reportStr << "Insertion Sort";
-		break;
+	if (param->countingRange > 0)
+	{
+		reportStr << "Sort Engine       : Counting Sort (key range " << param->countingRange << ")\n";
+	}
 	
-	case SortAlgorithm::Merge:
-		
-		reportStr << "Merge Sort";
-		break;
+	if (param->recordSize > 0)
+	{
+		reportStr << "Record Size       : " << param->recordSize << " bytes\n";
+		reportStr << "Record Layout     : " << getRecordLayoutName(param->recordLayout) << "\n";
+		reportStr << "Record Engine     : " << getRecordEngineName(param->recordEngine) << "\n";
+	}
 	
-	case SortAlgorithm::Quick:
-		
-		reportStr << "Quick Sort";
-		break;
+	if (param->argsortBits > 0)
+	{
+		reportStr << "Argsort Indices   : " << param->argsortBits << "-bit (" << getRecordEngineName(param->recordEngine) << " engine)\n";
+		reportStr << "Gather Time       : " << param->gatherTime << " (order applied to the values)\n";
+	}
+	
+	if (param->strings)
+	{
+		reportStr << "String Arena      : " << formatMemorySize(param->stringBytes) << " of lines, " << sizeof(StringKey) << " byte keys (8 byte prefix + pointer)\n";
+	}
+	
+	if (param->stream)
+	{
+		reportStr << "Input Mode        : Streaming (" << info->stream.numChunks << " chunks of up to " << param->chunkSize << " values, " << info->stream.numWorkers << " sorting threads)\n";
+	}
+	
+	if (param->selection == SelectionMode::Nth)
+	{
+		reportStr << "Selected Value    : " << param->selectedValue << "\n";
 	}
 	
-	reportStr << "\n";
 	reportStr << "Parallel Version  : " << ((param->parallel) ? "yes" : "no") << "\n";
 	
 	if (param->parallel)
@@ -445,6 +745,39 @@ void generateReport(SortParameters* param, OutputInfo* info)
 	}
 	
 	reportStr << "Execution Time    : " << info->runTime << " seconds\n";
+	reportStr << "CPU Path          : " << getCpuPathName(getCpuPath());
+	
+	if (getCpuPath() != detectCpuPath())
+		reportStr << " (forced by --cpu-path, best supported: " << getCpuPathName(detectCpuPath()) << ")\n";
+	else
+		reportStr << " (best supported, detected at startup)\n";
+	
+	if (param->algorithm == SortAlgorithm::Merge && param->selection == SelectionMode::None && !param->stream && param->recordSize == 0)
+	{
+		if (param->lowMemory)
+			reportStr << "Merge Memory      : In place (--low-memory), no scratch buffers, O(n log^2 n) time\n";
+		else
+			reportStr << "Merge Memory      : Scratch buffers of up to " << formatMemorySize(info->dataLength * sizeof(int32_t)) << " (--low-memory merges in place)\n";
+	}
+	
+	reportStr << "Allocations       : " << info->memory.allocations << " (" << formatMemorySize(info->memory.bytesAllocated) << " requested during the sort)\n";
+	reportStr << "Peak Heap Growth  : " << formatMemorySize(info->memory.peakHeapGrowth) << "\n";
+	reportStr << "Peak Memory       : " << formatMemorySize(info->memory.peakResident) << " (peak resident set size "
+	          << ((info->memory.peakResidentIsLocal) ? "during the sort" : "of the whole process") << ")\n";
+	reportStr << "Page Faults       : " << info->memory.minorFaults << " minor, " << info->memory.majorFaults << " major\n";
+	
+	if (getHugePageBuffers())
+		reportStr << "Huge Pages        : " << info->memory.hugePageAllocations << " buffers advised (transparent huge pages: " << getTransparentHugePageMode() << ")\n";
+	else
+		reportStr << "Huge Pages        : Off (--no-huge-pages)\n";
+	
+	if (param->stream)
+	{
+		reportStr << "  Read and Parse  : " << info->stream.readTime << " seconds (chunks sorted meanwhile)\n";
+		reportStr << "  Sort Drain      : " << info->stream.drainTime << " seconds\n";
+		reportStr << "  Merge           : " << info->stream.mergeTime << " seconds\n";
+	}
+	
 	reportStr << "Verification      : ";
 	
 	if (param->verify)
@@ -484,40 +817,141 @@ void generateReport(SortParameters* param, OutputInfo* info)
 }
 
 
-// Adds an entry to "log.csv"
+// Gets the kind of run 'param' describes, as recorded in the results log
 //
-void logInfo(SortParameters* param, OutputInfo* info)
+std::string getRunMode(SortParameters* param)
 {
-	std::cout << " Saving to log... ";
-	
-	std::fstream log("log.csv", std::ios::in | std::ios::out | std::ios::app);
-	
-	if (log.is_open())
+	if (param->serveSocket != "")
+		return "service";
+	else if (param->batch != "")
+		return "batch";
+	else if (param->regressSuite != "")
+		return "regress";
+	else if (param->sweep)
+		return "sweep";
+	else if (param->processes > 0)
+		return "distributed";
+	else if (param->recordSize > 0)
+		return "records";
+	else if (param->argsortBits > 0)
+		return "argsort";
+	else if (param->strings)
+		return "strings";
+	else if (param->selection == SelectionMode::TopK)
+		return "topk";
+	else if (param->selection == SelectionMode::Nth)
+		return "nth";
+	else if (param->stream)
+		return "stream";
+	
+	return "sort";
+}
+
+
+// Gets one results log line: every parameter of the run, every timing and counter it collected, and the
+// fingerprint of the machine and build it ran on
+//
+std::string getResultJSON(SortParameters* param, OutputInfo* info)
+{
+	static EnvironmentInfo env = getEnvironmentInfo();
+	
+	std::stringstream json;
+	
+	json << std::setprecision(6) << std::fixed;
+	
+	json << "{"
+	     << "\"timestamp\": " << jsonString(getUTCTimestamp()) << ", "
+	     << "\"dataset\": " << jsonString(param->dataFile) << ", "
+	     << "\"mode\": " << jsonString(getRunMode(param)) << ", "
+	     << "\"algorithm\": " << jsonString(info->algorithmName) << ", "
+	     << "\"size\": " << info->dataLength << ", "
+	     << "\"time\": " << info->seconds << ", "
+	     << "\"verified\": " << ((param->verify) ? "true" : "false") << ", "
+	     << "\"sorted_correctly\": " << ((param->verify && info->sortedCorrectly) ? "true" : "false") << ", ";
+	
+	json << "\"parameters\": {"
+	     << "\"algorithm\": " << jsonString(getAlgorithmKey(param->algorithm)) << ", "
+	     << "\"parallel\": " << ((param->parallel) ? "true" : "false") << ", "
+	     << "\"threads\": " << ((param->parallel) ? param->numThreads : 1) << ", "
+	     << "\"stream\": " << ((param->stream) ? "true" : "false") << ", "
+	     << "\"chunk_size\": " << param->chunkSize << ", "
+	     << "\"counting_sort\": " << ((param->countingSort) ? "true" : "false") << ", "
+	     << "\"low_memory\": " << ((param->lowMemory) ? "true" : "false") << ", "
+	     << "\"tile_size\": " << param->tileSize << ", "
+	     << "\"merge_ways\": " << param->mergeWays << ", "
+	     << "\"select_rank\": " << param->selectRank << ", "
+	     << "\"record_size\": " << param->recordSize << ", "
+	     << "\"record_layout\": " << jsonString((param->recordLayout == RecordLayout::StructOfArrays) ? "soa" : "aos") << ", "
+	     << "\"record_engine\": " << jsonString((param->recordEngine == RecordEngine::Radix) ? "radix" : "merge") << ", "
+	     << "\"column_width\": " << param->columnWidth << ", "
+	     << "\"argsort_bits\": " << param->argsortBits << ", "
+	     << "\"strings\": " << ((param->strings) ? "true" : "false") << ", "
+	     << "\"processes\": " << param->processes << ", "
+	     << "\"huge_pages\": " << ((getHugePageBuffers()) ? "true" : "false") << "}, ";
+	
+	json << "\"counters\": {"
+	     << "\"allocations\": " << info->memory.allocations << ", "
+	     << "\"bytes_allocated\": " << info->memory.bytesAllocated << ", "
+	     << "\"peak_heap_growth\": " << info->memory.peakHeapGrowth << ", "
+	     << "\"huge_page_allocations\": " << info->memory.hugePageAllocations << ", "
+	     << "\"peak_resident\": " << info->memory.peakResident << ", "
+	     << "\"minor_faults\": " << info->memory.minorFaults << ", "
+	     << "\"major_faults\": " << info->memory.majorFaults << ", "
+	     << "\"counting_range\": " << param->countingRange << ", "
+	     << "\"selected_value\": " << param->selectedValue << ", "
+	     << "\"stream_chunks\": " << info->stream.numChunks << ", "
+	     << "\"stream_workers\": " << info->stream.numWorkers << ", "
+	     << "\"stream_read_time\": " << info->stream.readTime << ", "
+	     << "\"stream_drain_time\": " << info->stream.drainTime << ", "
+	     << "\"stream_merge_time\": " << info->stream.mergeTime << ", "
+	     << "\"gather_time\": " << param->gatherSeconds << ", "
+	     << "\"string_bytes\": " << param->stringBytes << ", "
+	     << "\"load_time\": " << info->loadTime << ", "
+	     << "\"queue_time\": " << info->queueTime;
+	
+	if (info->distributed != nullptr)
 	{
-		switch (param->algorithm)
-		{
-		case SortAlgorithm::Bubble:
-			
-			log << "Bubble Sort,";
-			break;
+		json << ", \"distributed_phases\": {";
 		
-		case SortAlgorithm::Insertion:
+		for (int32_t p = 0; p < (int32_t)DistributedPhase::Count; p++)
+		{
+			PhaseStats* phase = &(info->distributed->phases[p]);
 			
-			log << "Insertion Sort,";
-			break;
-		
-		case SortAlgorithm::Merge:
+			std::string name = getDistributedPhaseName((DistributedPhase)p);
 			
-			log << "Merge Sort,";
-			break;
-		
-		case SortAlgorithm::Quick:
+			std::transform(name.begin(), name.end(), name.begin(), [](char c) { return (c == ' ') ? '_' : (char)std::tolower((unsigned char)c); });
 			
-			log << "Quick Sort,";
-			break;
+			json << ((p > 0) ? ", " : "") << jsonString(name) << ": {"
+			     << "\"seconds\": " << phase->seconds << ", "
+			     << "\"bytes\": " << phase->bytes << "}";
 		}
 		
-		log << ((param->parallel) ? param->numThreads : 1) << "," << param->data.size() << "," << info->runTime << "\n";
+		json << "}";
+	}
+	
+	json << "}, ";
+	
+	json << "\"environment\": " << getEnvironmentJSON(&env) << "}";
+	
+	return json.str();
+}
+
+
+// Adds an entry to "log.csv": algorithm, threads, data length, run time, allocations, bytes allocated,
+// peak heap growth, peak resident set size, minor and major page faults. The full result goes to the
+// JSON lines results log as well
+//
+void logInfo(SortParameters* param, OutputInfo* info)
+{
+	std::cout << " Saving to log... ";
+	
+	std::fstream log("log.csv", std::ios::in | std::ios::out | std::ios::app);
+	
+	if (log.is_open())
+	{
+		log << info->algorithmName << "," << ((param->parallel) ? param->numThreads : 1) << "," << info->dataLength << "," << info->runTime << ","
+		    << info->memory.allocations << "," << info->memory.bytesAllocated << "," << info->memory.peakHeapGrowth << ","
+		    << info->memory.peakResident << "," << info->memory.minorFaults << "," << info->memory.majorFaults << "\n";
 		
 		std::cout << "Done\n\n";
 	}
@@ -525,69 +959,1052 @@ void logInfo(SortParameters* param, OutputInfo* info)
 	{
 		std::cout << "   ERROR: Failed to open log.\n\n";
 	}
+	
+	std::cout << " Saving results to \"" << param->resultsLog << "\"... ";
+	
+	if (appendJSONLine(param->resultsLog, getResultJSON(param, info)))
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Failed to write \"" << param->resultsLog << "\"\n\n";
+	}
 }
 
 
+// Gets the results log line of one sort of the sweep, batch, regression or service modes, which collect
+// their own results instead of an OutputInfo. The settings not given here are taken from 'param', and
+// 'loadTime' and 'queueTime' are 0 for the modes that do not measure them
+//
+std::string getRunResultJSON(SortParameters* param, std::string dataFile, SortAlgorithm algorithm, bool parallel, int32_t numThreads,
+                             size_t dataLength, double seconds, bool verified, bool sortedCorrectly, double loadTime, double queueTime)
+{
+	SortParameters run = *param;
+	
+	run.dataFile = dataFile;
+	run.algorithm = algorithm;
+	run.parallel = parallel;
+	run.numThreads = numThreads;
+	run.verify = verified;
+	
+	OutputInfo info{};
+	
+	info.timestamp = getTimestamp();
+	info.algorithmName = getAlgorithmName(algorithm);
+	info.dataLength = dataLength;
+	info.runTime = std::to_string(seconds);
+	info.seconds = seconds;
+	info.sortedCorrectly = sortedCorrectly;
+	info.loadTime = loadTime;
+	info.queueTime = queueTime;
+	
+	return getResultJSON(&run, &info);
+}
 
-/*** *** *** ENTRY POINT *** *** ***/
 
-int main(int argc, char** argv)
+// Appends the results log lines of a mode that runs many sorts, one per job, trial or configuration
+//
+void logResultLines(SortParameters* param, std::vector<std::string>* lines)
 {
-	/* Obtain parameters from user */
+	std::cout << " Saving " << lines->size() << " results to \"" << param->resultsLog << "\"... ";
 	
-	SortParameters param{};
+	bool written = true;
 	
-	parseCommandLineArgs(argc, argv, &param);
+	for (std::string& line : *lines)
+	{
+		written = written && appendJSONLine(param->resultsLog, line);
+	}
 	
-	if (param.dataFile == "")
+	if (written)
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Failed to write \"" << param->resultsLog << "\"\n\n";
+	}
+}
+
+
+// Runs the scaling sweep described by 'sweep' and saves its ".csv" and ".json" results
+//
+int runSweepMode(SortParameters* param, SweepParameters* sweep)
+{
+	if (sweep->dataFiles.empty())
 	{
 		std::cout << "\n   ERROR: Input file not specified\n\n";
 		exit(1);
 	}
-	else if (param.algorithm == SortAlgorithm::None)
+	else if (sweep->algorithms.empty())
 	{
 		std::cout << "\n   ERROR: Sorting algorithm not specified\n\n";
 		exit(1);
 	}
 	
+	if (sweep->threadCounts.empty())
+	{
+		sweep->threadCounts = getDefaultSweepThreads();
+	}
+	
+	sweep->verify = param->verify;
 	
-	/* Prepare Test Data */
+	std::cout << "\n *** Starting Sweep ***\n\n";
 	
-	loadTestData(param.dataFile, &(param.data));
+	std::vector<SweepResult> results;
 	
+	runSweep(sweep, &results);
 	
-	/* Sort Test Data */
+	std::cout << "\n *** Sweep complete ***\n\n";
 	
-	std::cout << "\n *** Starting Sort ***\n";
+	std::vector<std::string> lines;
+	
+	for (SweepResult& r : results)
+	{
+		lines.push_back(getRunResultJSON(param, r.dataFile, r.algorithm, r.parallel, r.numThreads, r.dataLength, r.time, r.verified, r.sortedCorrectly, 0.0, 0.0));
+	}
+	
+	logResultLines(param, &lines);
+	
+	std::string timestamp = getTimestamp();
+	std::string fileName = "sweep_" + timestamp;
+	
+	std::cout << " Saving sweep results... ";
+	
+	if (writeSweepCSV(&results, fileName + ".csv") && writeSweepJSON(sweep, &results, timestamp, fileName + ".json"))
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Failed to save \"" << fileName << "\"\n\n";
+		return 2;
+	}
+	
+	return 0;
+}
+
+
+// Sorts every job of the batch manifest or directory 'param->batch', then saves the consolidated report.
+// Returns 4 if any job could not be loaded or failed verification
+//
+int runBatchMode(SortParameters* param)
+{
+	BatchJob defaults;
+	
+	defaults.algorithm = param->algorithm;
+	defaults.parallel = param->parallel;
+	defaults.numThreads = param->numThreads;
+	
+	std::vector<BatchJob> jobs;
+	std::string error;
+	
+	if (!readBatchManifest(param->batch, defaults, &jobs, &error))
+	{
+		std::cout << "\n   ERROR: " << error << "\n\n";
+		exit(1);
+	}
+	else if (jobs.empty())
+	{
+		std::cout << "\n   ERROR: No batch jobs found in \"" << param->batch << "\"\n\n";
+		exit(1);
+	}
+	else if (defaults.algorithm == SortAlgorithm::None && std::filesystem::is_directory(param->batch))
+	{
+		std::cout << "\n   ERROR: Sorting algorithm not specified\n\n";
+		exit(1);
+	}
+	
+	int32_t numCores = param->batchCores;
+	
+	if (numCores == 0)
+	{
+		numCores = std::max<int32_t>(1, std::thread::hardware_concurrency());
+	}
+	
+	std::cout << "\n *** Starting Batch (" << jobs.size() << " jobs, " << numCores << " cores) ***\n\n";
+	
+	std::vector<BatchResult> results;
 	
 	Stopwatch timer;
 	timer.start();
 	
-	runSortingAlgorithm(&param);
+	runBatch(&jobs, numCores, param->verify, &results);
 	
 	timer.stop();
 	
-	std::cout << "\n *** Sort complete ***\n\n";
+	std::cout << "\n *** Batch complete ***\n\n";
 	
+	std::vector<std::string> lines;
 	
-	/* Get Execution Time */
+	for (BatchResult& r : results)
+	{
+		if (r.loaded)
+			lines.push_back(getRunResultJSON(param, r.job.dataFile, r.job.algorithm, r.job.parallel, r.cores, r.dataLength, r.sortTime, r.verified, r.sortedCorrectly, r.loadTime, 0.0));
+	}
 	
-	OutputInfo info{};
+	logResultLines(param, &lines);
 	
-	info.runTime = timer.getFormattedTime();
+	std::string timestamp = getTimestamp();
+	std::string fileName = "batch_" + timestamp;
 	
+	std::cout << " Saving batch report... ";
 	
-	/* Generate Timestamp Info */
+	if (writeBatchReport(&results, numCores, timer.getSeconds(), timestamp, fileName + ".report") && writeBatchCSV(&results, fileName + ".csv"))
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Failed to save \"" << fileName << "\"\n\n";
+		return 2;
+	}
 	
-	info.timestamp = getTimestamp();
-	info.stampedFilename = getTimestampedFilename(info.timestamp, &param);
+	size_t failed = 0;
 	
+	for (BatchResult& result : results)
+	{
+		if (!result.loaded || (result.verified && !result.sortedCorrectly))
+			failed++;
+	}
 	
-	/* Verify Results */
+	if (failed > 0)
+	{
+		std::cout << "   WARNING: " << failed << " of " << results.size() << " jobs failed to load or were not sorted correctly\n\n";
+		return 4;
+	}
 	
-	if (param.verify)
+	return 0;
+}
+
+
+// Times every case of the suite 'param->regressSuite', then compares the results to the baseline and/or
+// saves them as a new one. Returns 3 if any case regressed or failed
+//
+int runRegressionMode(SortParameters* param)
+{
+	if (param->baseline == "" && param->saveBaseline == "")
+	{
+		std::cout << "\n   ERROR: --regress needs --baseline and/or --save-baseline\n\n";
+		exit(1);
+	}
+	
+	BatchJob defaults;
+	
+	defaults.algorithm = param->algorithm;
+	defaults.parallel = param->parallel;
+	defaults.numThreads = param->numThreads;
+	
+	std::vector<BatchJob> jobs;
+	std::vector<RegressionCase> baseline;
+	std::string error;
+	
+	if (!readBatchManifest(param->regressSuite, defaults, &jobs, &error))
+	{
+		std::cout << "\n   ERROR: " << error << "\n\n";
+		exit(1);
+	}
+	else if (jobs.empty())
+	{
+		std::cout << "\n   ERROR: No regression cases found in \"" << param->regressSuite << "\"\n\n";
+		exit(1);
+	}
+	else if (defaults.algorithm == SortAlgorithm::None && std::filesystem::is_directory(param->regressSuite))
+	{
+		std::cout << "\n   ERROR: Sorting algorithm not specified\n\n";
+		exit(1);
+	}
+	
+	/* Read the baseline first, so a bad file is reported before the suite runs */
+	
+	if (param->baseline != "" && !readBaselineJSON(param->baseline, &baseline, &error))
+	{
+		std::cout << "\n   ERROR: " << error << "\n\n";
+		exit(2);
+	}
+	
+	int32_t trials = (param->trials > 0) ? param->trials : DEFAULT_REGRESSION_TRIALS;
+	int32_t threshold = (param->regressThreshold > 0) ? param->regressThreshold : DEFAULT_REGRESSION_THRESHOLD;
+	
+	std::cout << "\n *** Starting Regression Suite (" << jobs.size() << " cases, " << trials << " trials each) ***\n\n";
+	
+	std::vector<RegressionCase> cases;
+	
+	runRegressionSuite(&jobs, trials, param->verify, &cases);
+	
+	std::cout << "\n *** Regression Suite complete ***\n\n";
+	
+	/* One line per trial, so the spread the gate works from is in the results log as well */
+	
+	std::vector<std::string> lines;
+	
+	for (RegressionCase& c : cases)
+	{
+		for (double throughput : c.throughputs)
+		{
+			if (c.loaded && throughput > 0)
+				lines.push_back(getRunResultJSON(param, c.job.dataFile, c.job.algorithm, c.job.parallel, c.job.numThreads, c.dataLength, c.dataLength / throughput, c.verified, c.sortedCorrectly, 0.0, 0.0));
+		}
+	}
+	
+	logResultLines(param, &lines);
+	
+	int32_t exitCode = 0;
+	
+	if (param->baseline != "")
+	{
+		std::vector<RegressionComparison> comparisons;
+		
+		compareToBaseline(&cases, &baseline, threshold, &comparisons);
+		
+		std::cout << " Compared to \"" << param->baseline << "\" (threshold " << threshold << "%, 95% confidence):\n\n";
+		
+		std::vector<RegressionComparison*> offending;
+		
+		for (RegressionComparison& c : comparisons)
+		{
+			std::cout << "   " << getRegressionCaseKey(&(c.current.job)) << ": " << getRegressionStatusName(c.status);
+			
+			if (c.status == RegressionStatus::Unchanged || c.status == RegressionStatus::Regressed || c.status == RegressionStatus::Improved)
+			{
+				std::cout << std::fixed << std::setprecision(1) << "  " << std::showpos << (c.change * 100) << "% [" << (c.changeLow * 100)
+				          << "%, " << (c.changeHigh * 100) << "%]" << std::noshowpos << std::setprecision(3)
+				          << "  (" << (c.baseline.meanThroughput / 1e6) << " -> " << (c.current.meanThroughput / 1e6) << " M values/s)";
+			}
+			else if (c.status == RegressionStatus::Failed)
+			{
+				std::cout << "  (" << ((c.current.loaded) ? "not sorted correctly" : c.current.error) << ")";
+			}
+			
+			std::cout << "\n";
+			
+			if (c.status == RegressionStatus::Regressed || c.status == RegressionStatus::Failed)
+			{
+				offending.push_back(&c);
+			}
+		}
+		
+		if (!offending.empty())
+		{
+			std::cout << "\n   ERROR: " << offending.size() << " case(s) regressed or failed:\n\n";
+			
+			for (RegressionComparison* c : offending)
+			{
+				std::cout << "     " << getRegressionCaseKey(&(c->current.job)) << "\n";
+			}
+			
+			exitCode = 3;
+		}
+		else
+		{
+			std::cout << "\n   No regressions\n";
+		}
+		
+		std::cout << "\n";
+	}
+	
+	if (param->saveBaseline != "")
+	{
+		std::cout << " Saving baseline... ";
+		
+		if (writeBaselineJSON(&cases, getTimestamp(), param->saveBaseline))
+		{
+			std::cout << "Done\n\n";
+		}
+		else
+		{
+			std::cout << "   ERROR: Failed to save \"" << param->saveBaseline << "\"\n\n";
+			return 2;
+		}
+	}
+	
+	return exitCode;
+}
+
+
+// Loads, stably sorts and verifies the fixed width records described by 'param', then saves the report and log entry
+//
+int runRecordMode(SortParameters* param)
+{
+	if (param->dataFile == "")
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	
+	
+	/* Prepare Test Data */
+	
+	RecordArray records;
+	RecordColumns columns;
+	
+	loadRecordFile(param->dataFile, param->recordSize, &records);
+	
+	if (param->recordLayout == RecordLayout::StructOfArrays && records.size() > MAX_PACKED_ROWS)
+	{
+		std::cout << "\n   ERROR: The struct of arrays layout sorts at most " << MAX_PACKED_ROWS << " records (file has " << records.size() << ")\n\n";
+		exit(2);
+	}
+	
+	if (param->recordLayout == RecordLayout::StructOfArrays)
+	{
+		splitRecordColumns(&records, param->columnWidth, &columns);
+		
+		std::vector<uint8_t>().swap(records.bytes);
+	}
+	
+	RecordArray originalRecords;
+	RecordColumns originalColumns;
+	
+	if (param->verify)
+	{
+		if (param->recordLayout == RecordLayout::StructOfArrays)
+			originalColumns = columns;
+		else
+			originalRecords = records;
+	}
+	
+	
+	/* Sort Test Data */
+	
+	std::cout << "\n *** Starting Sort ***\n";
+	
+	MemoryStats memory;
+	startMemoryStats(&memory);
+	
+	Stopwatch timer;
+	timer.start();
+	
+	if (param->recordLayout == RecordLayout::StructOfArrays)
+	{
+		if (param->parallel)
+			parSortRecordColumns(&columns, param->recordEngine, param->numThreads);
+		else
+			seqSortRecordColumns(&columns, param->recordEngine);
+	}
+	else
+	{
+		if (param->parallel)
+			parSortRecordArray(&records, param->recordEngine, param->numThreads);
+		else
+			seqSortRecordArray(&records, param->recordEngine);
+	}
+	
+	timer.stop();
+	
+	stopMemoryStats(&memory);
+	
+	std::cout << "\n *** Sort complete ***\n\n";
+	
+	
+	/* Generate Output Info */
+	
+	OutputInfo info{};
+	
+	info.algorithmName = "Stable Record Sort (" + getRecordEngineName(param->recordEngine) + ", " + getRecordLayoutName(param->recordLayout) + ")";
+	info.dataLength = (param->recordLayout == RecordLayout::StructOfArrays) ? columns.size() : records.size();
+	info.runTime = timer.getFormattedTime();
+	info.seconds = timer.getSeconds();
+	info.memory = memory;
+	
+	info.timestamp = getTimestamp();
+	info.stampedFilename = "records_" + std::string((param->recordLayout == RecordLayout::StructOfArrays) ? "soa_" : "aos_")
+	                     + ((param->recordEngine == RecordEngine::Radix) ? "radix_" : "merge_")
+	                     + ((param->parallel) ? "par_" : "seq_") + info.timestamp;
+	
+	
+	/* Verify Results */
+	
+	if (param->verify)
+	{
+		std::cout << " Verifying... ";
+		
+		if (param->recordLayout == RecordLayout::StructOfArrays)
+			info.sortedCorrectly = isStablySorted(&columns, &originalColumns);
+		else
+			info.sortedCorrectly = isStablySorted(&records, &originalRecords);
+		
+		std::cout << ((info.sortedCorrectly) ? "Done\n\n" : "\n\n   WARNING: Records are not stably sorted\n\n");
+	}
+	
+	generateReport(param, &info);
+	
+	logInfo(param, &info);
+	
+	return 0;
+}
+
+
+
+// Runs the sort service on 'param->serveSocket' until it is stopped
+//
+int runServiceMode(SortParameters* param)
+{
+	std::cout << "\n *** Sort service listening on \"" << param->serveSocket << "\" (" << param->numThreads << " workers) ***\n";
+	
+	/* Every request served gets a results log line. The connections log at the same time, and the
+	   timestamp comes from std::localtime, so they take turns */
+	
+	std::mutex logLock;
+	
+	auto logResult = [param, &logLock](ServiceResult* result)
+	{
+		std::lock_guard<std::mutex> guard(logLock);
+		
+		std::string line = getRunResultJSON(param, "", result->algorithm, result->parallel, result->numThreads, result->dataLength, result->sortTime, false, false, 0.0, result->queueTime);
+		
+		appendJSONLine(param->resultsLog, line);
+	};
+	
+	std::string error;
+	
+	if (!runSortService(param->serveSocket, param->numThreads, param->numThreads, logResult, &error))
+	{
+		std::cout << "\n   ERROR: " << error << "\n\n";
+		exit(2);
+	}
+	
+	std::cout << "\n *** Sort service stopped ***\n\n";
+	
+	return 0;
+}
+
+
+// Sends 'param->dataFile' to the sort service 'param->requests' times, or asks it for its statistics or
+// to stop, then saves the log entry of the requests
+//
+int runClientMode(SortParameters* param)
+{
+	std::string error;
+	
+	if (param->serviceStats || param->serviceStop)
+	{
+		std::string stats;
+		
+		if (param->serviceStats && !requestStats(param->clientSocket, &stats, &error))
+		{
+			std::cout << "\n   ERROR: " << error << "\n\n";
+			exit(2);
+		}
+		else if (param->serviceStats)
+		{
+			std::cout << "\n " << stats << "\n\n";
+		}
+		
+		if (param->serviceStop && !requestShutdown(param->clientSocket, &error))
+		{
+			std::cout << "\n   ERROR: " << error << "\n\n";
+			exit(2);
+		}
+		
+		return 0;
+	}
+	else if (param->dataFile == "")
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	
+	std::vector<int32_t> original;
+	
+	loadTestData(param->dataFile, &original);
+	
+	std::cout << "\n *** Sending " << param->requests << " request(s) to \"" << param->clientSocket << "\" ***\n\n";
+	
+	std::vector<double> roundTrips;
+	ServiceTiming timing;
+	
+	OutputInfo info{};
+	
+	info.sortedCorrectly = true;
+	
+	for (int32_t r = 0; r < param->requests; r++)
+	{
+		param->data = original;
+		
+		if (!requestSort(param->clientSocket, &(param->data), param->algorithm, param->sharedMemory, &timing, &error))
+		{
+			std::cout << "   ERROR: " << error << "\n\n";
+			exit(2);
+		}
+		
+		roundTrips.push_back(timing.roundTrip);
+		
+		if (param->verify)
+		{
+			info.sortedCorrectly = info.sortedCorrectly && param->data.size() == original.size() && isSorted(&(param->data));
+		}
+	}
+	
+	std::sort(roundTrips.begin(), roundTrips.end());
+	
+	double median = roundTrips[roundTrips.size() / 2];
+	double p99 = roundTrips[std::min(roundTrips.size() - 1, roundTrips.size() * 99 / 100)];
+	
+	std::cout << std::fixed << std::setprecision(6);
+	std::cout << " Round trip        : " << median << " seconds median, " << p99 << " p99, " << roundTrips.back() << " max\n";
+	std::cout << " Last request      : " << timing.queue << " seconds queued, " << timing.sort << " sorting\n";
+	
+	if (param->verify)
+	{
+		std::cout << " Verification      : " << ((info.sortedCorrectly) ? "Data was properly sorted" : "Data was NOT properly sorted") << "\n";
+	}
+	
+	std::cout << std::defaultfloat << "\n";
+	
+	info.algorithmName = "Sort Service (" + ((param->algorithm == SortAlgorithm::None) ? "Quick Sort" : getAlgorithmName(param->algorithm))
+	                   + ", " + ((param->sharedMemory) ? "shared memory" : "inline") + ")";
+	info.dataLength = original.size();
+	info.runTime = std::to_string(median);
+	info.seconds = median;
+	info.timestamp = getTimestamp();
+	
+	logInfo(param, &info);
+	
+	/* Same code as a failed batch job, 1 is kept for command line errors */
+	
+	return (param->verify && !info.sortedCorrectly) ? 4 : 0;
+}
+
+
+
+// Sorts 'param->dataFile' over 'param->processes' worker processes, then saves the per-phase report and
+// the log entry
+//
+int runDistributedMode(SortParameters* param)
+{
+	if (param->dataFile == "")
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	else if (param->algorithm == SortAlgorithm::None)
+	{
+		std::cout << "\n   ERROR: Sorting algorithm not specified\n\n";
+		exit(1);
+	}
+	else if (param->stream || param->selection != SelectionMode::None)
+	{
+		std::cout << "\n   ERROR: --processes cannot be combined with --stream, --topk or --nth\n\n";
+		exit(1);
+	}
+	
+	loadTestData(param->dataFile, &(param->data));
+	
+	std::cout << "\n *** Starting Sort (" << param->processes << " processes) ***\n";
+	
+	DistributedResult result;
+	
+	if (!runDistributedSort(param, param->processes, &result))
+	{
+		std::cout << "\n   ERROR: " << result.error << "\n\n";
+		exit(2);
+	}
+	
+	std::cout << "\n *** Sort complete ***\n\n";
+	
+	OutputInfo info{};
+	
+	info.algorithmName = "Distributed " + getAlgorithmName(param->algorithm) + " (" + std::to_string(result.processes) + " processes)";
+	info.dataLength = result.dataLength;
+	info.runTime = std::to_string(result.wallTime);
+	info.seconds = result.wallTime;
+	info.distributed = &result;
+	
+	info.timestamp = getTimestamp();
+	info.stampedFilename = "distributed_" + info.timestamp;
+	
+	if (param->verify)
+	{
+		info.sortedCorrectly = verifyResults(&(param->data), info.stampedFilename);
+	}
+	
+	std::cout << " Saving report... ";
+	
+	if (writeDistributedReport(&result, param, info.timestamp, info.sortedCorrectly, info.stampedFilename + ".report"))
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Failed to save \"" << info.stampedFilename << ".report\"\n\n";
+	}
+	
+	logInfo(param, &info);
+	
+	return 0;
+}
+
+
+
+// Finds the sorted order of the values in 'param->dataFile' as 'Index' positions and saves it, then applies
+// it to the values the way a side column would be, verifies, and saves the report and log entry
+//
+template <typename Index>
+int runArgsortMode(SortParameters* param)
+{
+	if (param->dataFile == "")
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	
+	
+	/* Prepare Test Data */
+	
+	std::vector<int32_t> keys;
+	std::vector<Index> order;
+	
+	loadTestData(param->dataFile, &keys);
+	
+	if (sizeof(Index) == sizeof(uint32_t) && keys.size() > MAX_PACKED_ROWS)
+	{
+		std::cout << "\n   ERROR: 32-bit indexes address at most " << MAX_PACKED_ROWS << " keys (file has " << keys.size() << "), use --argsort 64\n\n";
+		exit(2);
+	}
+	
+	
+	/* Sort Test Data */
+	
+	std::cout << "\n *** Starting Sort ***\n";
+	
+	MemoryStats memory;
+	startMemoryStats(&memory);
+	
+	Stopwatch timer;
+	timer.start();
+	
+	if (param->parallel)
+		parArgsort(&keys, &order, param->recordEngine, param->numThreads);
+	else
+		seqArgsort(&keys, &order, param->recordEngine);
+	
+	timer.stop();
+	
+	stopMemoryStats(&memory);
+	
+	std::cout << "\n *** Sort complete ***\n\n";
+	
+	/* The keys stand in for a side column here: gathering them through the order has to sort them */
+	
+	std::vector<int32_t> gathered(keys.size());
+	
+	Stopwatch gatherTimer;
+	gatherTimer.start();
+	
+	applyPermutation(&order, (const uint8_t*)keys.data(), (uint8_t*)gathered.data(), sizeof(int32_t), (param->parallel) ? param->numThreads : 1);
+	
+	gatherTimer.stop();
+	
+	param->gatherTime = gatherTimer.getFormattedTime();
+	param->gatherSeconds = gatherTimer.getSeconds();
+	
+	
+	/* Generate Output Info */
+	
+	OutputInfo info{};
+	
+	info.algorithmName = "Argsort (" + getRecordEngineName(param->recordEngine) + ((keys.size() > MAX_PACKED_ROWS) ? ", key/index records)" : ", key/index pairs)");
+	info.dataLength = keys.size();
+	info.runTime = timer.getFormattedTime();
+	info.seconds = timer.getSeconds();
+	info.memory = memory;
+	
+	info.timestamp = getTimestamp();
+	info.stampedFilename = "argsort_" + std::to_string(param->argsortBits) + "_" + ((param->parallel) ? "par_" : "seq_") + info.timestamp;
+	
+	
+	/* Verify Results */
+	
+	if (param->verify)
+	{
+		std::cout << " Verifying... ";
+		
+		info.sortedCorrectly = isStableArgsort(&keys, &order) && isSorted(&gathered);
+		
+		std::cout << ((info.sortedCorrectly) ? "Done\n\n" : "\n\n   WARNING: Order does not stably sort the data\n\n");
+	}
+	
+	std::cout << " Saving sorted order... ";
+	
+	std::ofstream dump(info.stampedFilename + ".dump");
+	
+	for (Index index : order)
+	{
+		dump << index << " ";
+	}
+	
+	if (dump.good())
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Cannot create file \"" << info.stampedFilename << ".dump\"\n\n";
+	}
+	
+	dump.close();
+	
+	generateReport(param, &info);
+	
+	logInfo(param, &info);
+	
+	return 0;
+}
+
+
+
+// Loads, sorts and verifies the lines of 'param->dataFile', then saves them in order with the report and log entry
+//
+int runStringMode(SortParameters* param)
+{
+	if (param->dataFile == "")
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	
+	
+	/* Prepare Test Data */
+	
+	StringArena arena;
+	std::vector<StringKey> keys;
+	
+	loadStringFile(param->dataFile, &arena);
+	
+	makeStringKeys(&arena, &keys);
+	
+	param->stringBytes = arena.bytes.size();
+	
+	
+	/* Sort Test Data */
+	
+	std::cout << "\n *** Starting Sort ***\n";
+	
+	MemoryStats memory;
+	startMemoryStats(&memory);
+	
+	Stopwatch timer;
+	timer.start();
+	
+	if (param->parallel)
+		parSortStrings(&keys, param->numThreads);
+	else
+		seqSortStrings(&keys);
+	
+	timer.stop();
+	
+	stopMemoryStats(&memory);
+	
+	std::cout << "\n *** Sort complete ***\n\n";
+	
+	
+	/* Generate Output Info */
+	
+	OutputInfo info{};
+	
+	info.algorithmName = "String Sort (multikey quicksort)";
+	info.dataLength = keys.size();
+	info.runTime = timer.getFormattedTime();
+	info.seconds = timer.getSeconds();
+	info.memory = memory;
+	
+	info.timestamp = getTimestamp();
+	info.stampedFilename = "strings_" + std::string((param->parallel) ? "par_" : "seq_") + info.timestamp;
+	
+	
+	/* Verify Results */
+	
+	if (param->verify)
+	{
+		std::cout << " Verifying... ";
+		
+		info.sortedCorrectly = isStringSorted(&keys, &arena);
+		
+		std::cout << ((info.sortedCorrectly) ? "Done\n\n" : "\n\n   WARNING: Lines are not sorted\n\n");
+	}
+	
+	std::cout << " Saving sorted lines... ";
+	
+	if (writeStringFile(&keys, info.stampedFilename + ".dump"))
+	{
+		std::cout << "Done\n\n";
+	}
+	else
+	{
+		std::cout << "   ERROR: Cannot create file \"" << info.stampedFilename << ".dump\"\n\n";
+	}
+	
+	generateReport(param, &info);
+	
+	logInfo(param, &info);
+	
+	return 0;
+}
+
+
+
+/*** *** *** ENTRY POINT *** *** ***/
+
+int main(int argc, char** argv)
+{
+	/* Obtain parameters from user */
+	
+	SortParameters param{};
+	
+	SweepParameters sweep{};
+	
+	parseCommandLineArgs(argc, argv, &param, &sweep);
+	
+	if (param.sweep)
+	{
+		return runSweepMode(&param, &sweep);
+	}
+	else if (param.batch != "")
+	{
+		return runBatchMode(&param);
+	}
+	else if (param.regressSuite != "")
+	{
+		return runRegressionMode(&param);
+	}
+	else if (param.recordSize > 0)
+	{
+		return runRecordMode(&param);
+	}
+	else if (param.argsortBits == 64)
+	{
+		return runArgsortMode<uint64_t>(&param);
+	}
+	else if (param.argsortBits == 32)
+	{
+		return runArgsortMode<uint32_t>(&param);
+	}
+	else if (param.strings)
+	{
+		return runStringMode(&param);
+	}
+	else if (param.processes > 0)
+	{
+		return runDistributedMode(&param);
+	}
+	else if (param.serveSocket != "")
+	{
+		return runServiceMode(&param);
+	}
+	else if (param.clientSocket != "")
+	{
+		return runClientMode(&param);
+	}
+	
+	if (param.dataFile == "" && !param.stream)
+	{
+		std::cout << "\n   ERROR: Input file not specified\n\n";
+		exit(1);
+	}
+	else if (param.algorithm == SortAlgorithm::None && param.selection == SelectionMode::None)
+	{
+		std::cout << "\n   ERROR: Sorting algorithm not specified\n\n";
+		exit(1);
+	}
+	else if (param.stream && param.selection != SelectionMode::None)
+	{
+		std::cout << "\n   ERROR: --stream cannot be combined with --topk or --nth\n\n";
+		exit(1);
+	}
+	
+	
+	/* Prepare Test Data (streaming mode loads while sorting instead) */
+	
+	if (!param.stream)
+	{
+		loadTestData(param.dataFile, &(param.data));
+	}
+	
+	size_t dataLength = param.data.size();
+	
+	std::vector<int32_t> original;
+	
+	if (param.selection != SelectionMode::None)
+	{
+		if (param.selection == SelectionMode::Nth && param.selectRank >= dataLength)
+		{
+			std::cout << "\n   ERROR: Value for --nth must be less than the data length (" << dataLength << ")\n\n";
+			exit(1);
+		}
+		
+		if (param.verify)
+		{
+			original = param.data;
+		}
+	}
+	
+	
+	/* Sort Test Data */
+	
+	std::cout << "\n *** Starting Sort ***\n";
+	
+	OutputInfo info{};
+	
+	startMemoryStats(&(info.memory));
+	
+	Stopwatch timer;
+	timer.start();
+	
+	if (param.stream)
+	{
+		streamSort(&param, &(info.stream));
+		
+		dataLength = param.data.size();
+	}
+	else
+	{
+		runSortingAlgorithm(&param);
+	}
+	
+	timer.stop();
+	
+	stopMemoryStats(&(info.memory));
+	
+	std::cout << "\n *** Sort complete ***\n\n";
+	
+	
+	/* Get Execution Time */
+	
+	info.algorithmName = getAlgorithmName(param.algorithm);
+	info.dataLength = dataLength;
+	
+	if (param.selection == SelectionMode::TopK)
+		info.algorithmName = "Top-K Selection (k = " + std::to_string(param.selectRank) + ")";
+	else if (param.selection == SelectionMode::Nth)
+		info.algorithmName = "Nth Element Selection (n = " + std::to_string(param.selectRank) + ")";
+	info.runTime = timer.getFormattedTime();
+	info.seconds = timer.getSeconds();
+	
+	
+	/* Generate Timestamp Info */
+	
+	info.timestamp = getTimestamp();
+	info.stampedFilename = getTimestampedFilename(info.timestamp, &param);
+	
+	
+	/* Verify Results */
+	
+	if (param.verify)
+	{
+		if (param.selection != SelectionMode::None)
+			info.sortedCorrectly = verifySelection(&param, &original, info.stampedFilename);
+		else
+			info.sortedCorrectly = verifyResults(&(param.data), info.stampedFilename);
+	}
+	
+	if (param.selection == SelectionMode::TopK)
+	{
+		dumpToFile(&(param.data), info.stampedFilename, ".topk");
+	}
+	else if (param.selection == SelectionMode::Nth)
 	{
-		info.sortedCorrectly = verifyResults(&(param.data), info.stampedFilename);
+		std::cout << " Value at index " << param.selectRank << ": " << param.selectedValue << "\n\n";
 	}
 	
 	generateReport(&param, &info);